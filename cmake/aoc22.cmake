@@ -0,0 +1,209 @@
+# Shared by the top-level build and every dayNN/CMakeLists.txt, so a day can
+# still be configured on its own and ends up with the exact same flags.
+include_guard(GLOBAL)
+
+set(AOC22_CMAKE_DIR "${CMAKE_CURRENT_LIST_DIR}")
+
+if(NOT DEFINED CMAKE_TOOLCHAIN_FILE AND EXISTS "$ENV{HOME}/vcpkg/scripts/buildsystems/vcpkg.cmake")
+    include("$ENV{HOME}/vcpkg/scripts/buildsystems/vcpkg.cmake")
+endif()
+
+if(NOT CMAKE_BUILD_TYPE AND NOT CMAKE_CONFIGURATION_TYPES)
+    set(CMAKE_BUILD_TYPE Release CACHE STRING "" FORCE)
+endif()
+
+option(AOC22_LTO "Link time optimization" OFF)
+option(AOC22_NATIVE "Tune for the build machine (-march=native)" OFF)
+option(AOC22_SANITIZE "Build with -fsanitize=undefined" OFF)
+option(AOC22_STATIC "Link the solvers statically, no dynamic loader at startup" OFF)
+option(AOC22_ALLOC_STATS "Count heap allocations per benchmark phase (replaces operator new/delete)" OFF)
+option(AOC22_CONSTEXPR_INPUT "Solve the checked-in inputs at compile time where the day allows it" OFF)
+set(AOC22_CONSTEXPR_STEPS "" CACHE STRING "constexpr step limit for AOC22_CONSTEXPR_INPUT, empty for the compiler's default")
+set(AOC22_PGO "OFF" CACHE STRING "Profile guided optimization stage")
+set_property(CACHE AOC22_PGO PROPERTY STRINGS OFF GENERATE USE)
+set(AOC22_PGO_DIR "${CMAKE_BINARY_DIR}/pgo-profiles" CACHE PATH "Where profiles are written to / read from")
+
+find_package(Threads REQUIRED)
+
+find_path(FASTIO_INCLUDE_DIRS "fast_io.h")
+if(NOT FASTIO_INCLUDE_DIRS)
+    message(FATAL_ERROR "fast_io.h not found, install fast_io (vcpkg) or set FASTIO_INCLUDE_DIRS")
+endif()
+
+# which commit the solvers were configured at, for --results (it's only
+# refreshed when cmake reruns)
+set(AOC22_COMMIT "unknown")
+find_package(Git QUIET)
+if(GIT_FOUND)
+    execute_process(COMMAND ${GIT_EXECUTABLE} rev-parse --short=12 HEAD
+        WORKING_DIRECTORY "${AOC22_CMAKE_DIR}/.."
+        OUTPUT_VARIABLE commit OUTPUT_STRIP_TRAILING_WHITESPACE
+        RESULT_VARIABLE failed ERROR_QUIET)
+    if(NOT failed)
+        execute_process(COMMAND ${GIT_EXECUTABLE} diff --quiet HEAD
+            WORKING_DIRECTORY "${AOC22_CMAKE_DIR}/.."
+            RESULT_VARIABLE dirty ERROR_QUIET)
+        if(dirty)
+            string(APPEND commit "-dirty")
+        endif()
+        set(AOC22_COMMIT "${commit}")
+    endif()
+endif()
+
+if(AOC22_LTO)
+    include(CheckIPOSupported)
+    check_ipo_supported(RESULT AOC22_LTO_SUPPORTED OUTPUT AOC22_LTO_ERROR)
+    if(NOT AOC22_LTO_SUPPORTED)
+        message(WARNING "LTO not supported: ${AOC22_LTO_ERROR}")
+    endif()
+endif()
+
+if(AOC22_PGO STREQUAL "USE" AND CMAKE_CXX_COMPILER_ID MATCHES "Clang"
+   AND NOT EXISTS "${AOC22_PGO_DIR}/default.profdata")
+    message(WARNING "AOC22_PGO=USE but ${AOC22_PGO_DIR}/default.profdata does not exist")
+endif()
+
+# every solver target, with the directory its `input` lives in
+define_property(GLOBAL PROPERTY AOC22_DAYS
+    BRIEF_DOCS "aoc22 solver targets" FULL_DOCS "aoc22 solver targets")
+
+# helpers next to the solvers (tools/), same standard and fast_io
+function(aoc22_tool target)
+    set_property(TARGET ${target} PROPERTY CXX_STANDARD 23)
+    target_include_directories(${target} PRIVATE ${FASTIO_INCLUDE_DIRS})
+    target_link_libraries(${target} PRIVATE Threads::Threads)
+endfunction()
+
+function(aoc22_day target)
+    set_property(TARGET ${target} PROPERTY CXX_STANDARD 23)
+    target_include_directories(${target} PRIVATE ${FASTIO_INCLUDE_DIRS})
+    # --batch runs on a thread pool
+    target_link_libraries(${target} PRIVATE Threads::Threads)
+
+    if(AOC22_LTO AND AOC22_LTO_SUPPORTED)
+        set_property(TARGET ${target} PROPERTY INTERPROCEDURAL_OPTIMIZATION ON)
+    endif()
+
+    if(AOC22_NATIVE)
+        target_compile_options(${target} PRIVATE -march=native)
+    endif()
+
+    if(AOC22_STATIC)
+        target_link_options(${target} PRIVATE -static)
+    endif()
+
+    if(AOC22_ALLOC_STATS)
+        target_compile_definitions(${target} PRIVATE AOC22_ALLOC_STATS)
+    endif()
+
+    if(AOC22_SANITIZE)
+        target_compile_options(${target} PRIVATE -fsanitize=undefined)
+        target_link_options(${target} PRIVATE -fsanitize=undefined)
+    endif()
+
+    if(AOC22_PGO STREQUAL "GENERATE")
+        set(flags -fprofile-generate=${AOC22_PGO_DIR})
+        if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+            list(APPEND flags -fprofile-update=atomic -fprofile-prefix-path=${CMAKE_BINARY_DIR})
+        endif()
+        target_compile_options(${target} PRIVATE ${flags})
+        target_link_options(${target} PRIVATE ${flags})
+    elseif(AOC22_PGO STREQUAL "USE")
+        if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+            set(flags -fprofile-use=${AOC22_PGO_DIR}/default.profdata)
+        else()
+            set(flags -fprofile-use=${AOC22_PGO_DIR} -fprofile-partial-training
+                      -fprofile-prefix-path=${CMAKE_BINARY_DIR} -Wno-missing-profile)
+        endif()
+        target_compile_options(${target} PRIVATE ${flags})
+        target_link_options(${target} PRIVATE ${flags})
+    endif()
+
+    # the build type and whichever options change the code, for --results
+    set(build_flags "${CMAKE_BUILD_TYPE}")
+    foreach(option IN ITEMS LTO NATIVE SANITIZE STATIC ALLOC_STATS)
+        if(AOC22_${option})
+            string(TOLOWER "${option}" option)
+            string(APPEND build_flags " ${option}")
+        endif()
+    endforeach()
+    if(NOT AOC22_PGO STREQUAL "OFF")
+        string(TOLOWER " pgo-${AOC22_PGO}" pgo)
+        string(APPEND build_flags "${pgo}")
+    endif()
+    target_compile_definitions(${target} PRIVATE
+        AOC22_COMMIT="${AOC22_COMMIT}" AOC22_BUILD_FLAGS="${build_flags}")
+
+    set_property(GLOBAL APPEND PROPERTY AOC22_DAYS "${target}|${CMAKE_CURRENT_SOURCE_DIR}")
+endfunction()
+
+# ctest: with --stream in blocks of 1 to 7 bytes, where every record and
+# separator straddles blocks, the day still has to give the mapped answers
+function(aoc22_stream_tests target)
+    foreach(size RANGE 1 7)
+        add_test(NAME ${target}_stream_${size}
+            COMMAND ${CMAKE_COMMAND} -DSOLVER=$<TARGET_FILE:${target}>
+                    -DBLOCK_SIZE=${size} -P ${AOC22_CMAKE_DIR}/same_answers.cmake
+            WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR})
+    endforeach()
+endfunction()
+
+# AOC22_CONSTEXPR_INPUT: embeds the day's `input` as a constexpr string_view
+# and has main() print solve(parse(embedded_input)), computed by the
+# compiler. Whether that works depends on the input, the compiler and its
+# constexpr step limit, so it's tried once at configure time, the day stays a
+# runtime solver if it doesn't.
+function(aoc22_constexpr_input target)
+    if(NOT AOC22_CONSTEXPR_INPUT)
+        return()
+    endif()
+
+    set(AOC22_INPUT_FILE "${CMAKE_CURRENT_SOURCE_DIR}/input")
+    if(NOT EXISTS "${AOC22_INPUT_FILE}")
+        message(STATUS "${target}: no input to embed, solved at runtime")
+        return()
+    endif()
+
+    # #embed would do, but neither gcc 12 nor clang 15 have it yet
+    set(dir "${CMAKE_CURRENT_BINARY_DIR}/embedded")
+    file(READ "${AOC22_INPUT_FILE}" AOC22_INPUT)
+    configure_file("${AOC22_CMAKE_DIR}/embedded_input.hh.in"
+                   "${dir}/embedded_input.hh" @ONLY)
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${AOC22_INPUT_FILE}")
+
+    set(flags "")
+    if(AOC22_CONSTEXPR_STEPS)
+        if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+            set(flags -fconstexpr-steps=${AOC22_CONSTEXPR_STEPS})
+        else()
+            set(flags -fconstexpr-ops-limit=${AOC22_CONSTEXPR_STEPS}
+                      -fconstexpr-loop-limit=${AOC22_CONSTEXPR_STEPS})
+        endif()
+    endif()
+
+    set(CMAKE_TRY_COMPILE_TARGET_TYPE STATIC_LIBRARY)
+    try_compile(solved "${CMAKE_CURRENT_BINARY_DIR}/constexpr-probe"
+        SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/main.cc"
+        CMAKE_FLAGS "-DINCLUDE_DIRECTORIES=${FASTIO_INCLUDE_DIRS};${dir}"
+        COMPILE_DEFINITIONS -DAOC22_CONSTEXPR_SOLVE ${flags}
+        CXX_STANDARD 23
+        CXX_STANDARD_REQUIRED ON
+        OUTPUT_VARIABLE output)
+
+    if(NOT solved)
+        if(output MATCHES "constexpr-ops-limit|constexpr-loop-limit|constexpr-steps|maximum step limit")
+            message(WARNING "${target}: solving the input at compile time hits the "
+                            "constexpr step limit, it's solved at runtime instead "
+                            "(a larger AOC22_CONSTEXPR_STEPS may get it through)")
+        else()
+            message(WARNING "${target}: solve(parse(input)) isn't a constant "
+                            "expression with this compiler, it's solved at runtime instead")
+        endif()
+        return()
+    endif()
+
+    message(STATUS "${target}: input solved at compile time")
+    target_compile_definitions(${target} PRIVATE AOC22_CONSTEXPR_SOLVE)
+    target_include_directories(${target} PRIVATE ${dir})
+    target_compile_options(${target} PRIVATE ${flags})
+endfunction()
@@ -0,0 +1,22 @@
+# ctest helper, `cmake -DSOLVER=... -DBLOCK_SIZE=N -P same_answers.cmake` in
+# a day's directory: --stream with BLOCK_SIZE byte blocks has to give the
+# answers the mapped input gives.
+foreach(mode IN ITEMS mapped stream)
+    set(args --warmup 0 --runs 1 --json)
+    if(mode STREQUAL "stream")
+        list(APPEND args --stream --block-size ${BLOCK_SIZE})
+    endif()
+    execute_process(COMMAND ${SOLVER} ${args}
+        OUTPUT_VARIABLE output RESULT_VARIABLE failed)
+    if(failed)
+        message(FATAL_ERROR "${SOLVER} ${args} failed: ${failed}")
+    endif()
+    string(REGEX MATCH "\"answers\":\\[[^]]*\\]" ${mode} "${output}")
+    if(NOT ${mode})
+        message(FATAL_ERROR "${SOLVER} ${args} printed no answers")
+    endif()
+endforeach()
+
+if(NOT mapped STREQUAL stream)
+    message(FATAL_ERROR "--block-size ${BLOCK_SIZE}: ${stream}, mapped: ${mapped}")
+endif()
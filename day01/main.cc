@@ -48,22 +48,141 @@ constexpr auto example = R"(1000
 static_assert(solve(parse(example)).first == 24'000);
 static_assert(solve(parse(example)).second == 45'000);
 
-int main() {
+// The `k` biggest elves so far, as a min-heap so the smallest of them is the
+// one to compare against.
+class top_k_t {
+  public:
+    explicit top_k_t(size_t k) : k{k} { heap.reserve(k); }
+
+    auto push(int64_t elf) -> void {
+        if (heap.size() < k) {
+            heap.push_back(elf);
+            rg::push_heap(heap, std::greater{});
+        } else if (elf > heap.front()) {
+            rg::pop_heap(heap, std::greater{});
+            heap.back() = elf;
+            rg::push_heap(heap, std::greater{});
+        }
+    }
+
+    auto merge(top_k_t const &other) -> void {
+        for (auto const elf : other.heap) {
+            push(elf);
+        }
+    }
+
+    // biggest, sum of all k
+    auto answer() const -> std::pair<int64_t, int64_t> {
+        if (heap.empty()) {
+            return {0, 0};
+        }
+        return {rg::max(heap), std::reduce(heap.begin(), heap.end())};
+    }
+
+  private:
+    size_t k;
+    std::vector<int64_t> heap;
+};
+
+// Calls `on_elf(total)` for every elf in `input`, which holds whole elves.
+// Newlines come out of match_64 64 bytes at a time and every line in between
+// is parsed with SWAR, an empty one closes the elf. `input` may be a piece of
+// a bigger buffer starting at `base`, the SWAR loads reach up to 7 bytes
+// back, which is fine as long as those are still in it.
+auto for_each_elf(std::string_view input, char const *base, auto &&on_elf)
+    -> void {
+    auto const *const begin = input.data();
+    auto const before = static_cast<size_t>(begin - base);
+    auto line = size_t{0};
+    auto total = int64_t{0};
+    auto foods = false;
+
+    auto const newline = [&](size_t end) {
+        auto const len = end - line;
+        if (len == 0) {
+            if (foods) {
+                on_elf(total);
+            }
+            total = 0;
+            foods = false;
+        } else {
+            total += len <= 8 && before + end >= 8
+                         ? parse_digits_unpadded(begin + line, len)
+                         : parse_digits(begin + line, len);
+            foods = true;
+        }
+        line = end + 1;
+    };
+
+    auto i = size_t{0};
+    for (; i + 64 <= input.size(); i += 64) {
+        for (auto mask = detail::match_64(begin + i, '\n'); mask;
+             mask &= mask - 1) {
+            newline(i + std::countr_zero(mask));
+        }
+    }
+    for (auto mask = detail::match_tail(begin + i, input.size() - i, '\n');
+         mask; mask &= mask - 1) {
+        newline(i + std::countr_zero(mask));
+    }
+
+    // no newline after the last food, nor after the last elf
+    if (line < input.size()) {
+        newline(input.size());
+    }
+    if (foods) {
+        on_elf(total);
+    }
+}
+
+// chunks are whole elves, only the top k has to be kept between them
+auto solve_stream(block_reader_t &reader, size_t k)
+    -> std::pair<int64_t, int64_t> {
+    auto top = top_k_t{k};
 
-    auto then = std::chrono::high_resolution_clock::now();
+    stream_records(reader, "\n\n"sv, 1, [&](std::string_view chunk) {
+        for_each_elf(chunk, chunk.data(),
+                     [&](int64_t elf) { top.push(elf); });
+    });
 
-    auto input = fast_io::native_file_loader("input");
-    
-    //auto elves = parse(input);
-    
-    auto [p1, p2] = solve(parse(input));
+    return top.answer();
+}
 
-    println(p1);
-    println(p2);
+// Every thread gets a few chunks cut between two elves, so none straddles
+// an edge, and keeps a top k of its own, merged at the end.
+auto solve_parallel(std::string_view input, size_t k)
+    -> std::pair<int64_t, int64_t> {
+    auto const chunks = split_records(input, "\n\n"sv);
+    auto const top = parallel_reduce(
+        chunks, top_k_t{k},
+        [&](std::string_view chunk) {
+            auto top = top_k_t{k};
+            for_each_elf(chunk, input.data(),
+                         [&](int64_t elf) { top.push(elf); });
+            return top;
+        },
+        [](top_k_t top, top_k_t const &other) {
+            top.merge(other);
+            return top;
+        });
 
-    auto now = std::chrono::high_resolution_clock::now();
-    auto diff = std::chrono::duration<double, std::micro> (now - then);
-    
-    println(diff.count(), "us");
+    return top.answer();
+}
 
-}
\ No newline at end of file
+int main(int argc, char **argv) {
+    auto const opts = bench::options_t::from_args(argc, argv, {"--top"sv});
+    // part 2 sums the 3 biggest elves, --top makes it any k
+    auto const k = static_cast<size_t>(std::max(1, opts.param("--top"sv, 3)));
+
+#if defined(AOC22_CONSTEXPR_SOLVE)
+    constexpr auto answer = solve(parse(embedded_input));
+    if (k == 3 && bench::print_precomputed(opts, "day01"sv, answer)) {
+        return 0;
+    }
+#endif
+
+    benchmark(opts, "day01"sv,
+              [](auto &input) { return std::string_view{input}; },
+              [&](std::string_view input) { return solve_parallel(input, k); },
+              [&](auto &reader) { return solve_stream(reader, k); });
+}
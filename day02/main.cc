@@ -1,3 +1,5 @@
+#include <cassert>
+
 #include "../lib/utils.hh"
 #include "fast_io.h"
 
@@ -94,24 +96,41 @@ C Z)"sv;
 static_assert(solve(parse(example)).first == 15);
 static_assert(solve(parse(example)).second == 12);
 
-auto solve_fast(const char *begin, const char *const end) {
-    auto part_1 = 0;
-    auto part_2 = 0;
+using score_t = std::pair<int64_t, int64_t>;
 
-    // clang-format off
-    char const score[3][3]{
-        {3, 0, 6}, 
-        {6, 3, 0}, 
-        {0, 6, 3}
-    };
-    char const should_play[3][3] {
-        {2, 0, 1},
-        {0, 1, 2},
-        {1, 2, 0},
-    };
-    // clang-format on
+// clang-format off
+// [p2][p1]
+constexpr char score[3][3]{
+    {3, 0, 6}, 
+    {6, 3, 0}, 
+    {0, 6, 3}
+};
+constexpr char should_play[3][3] {
+    {2, 0, 1},
+    {0, 1, 2},
+    {1, 2, 0},
+};
+// clang-format on
+
+// points of line p1 + 3 * p2, for both parts
+constexpr auto line_points = [] {
+    auto points = std::array<std::array<int, 9>, 2>{};
+    for (int p2 = 0; p2 < 3; ++p2) {
+        for (int p1 = 0; p1 < 3; ++p1) {
+            points[0][p1 + 3 * p2] = p2 + 1 + score[p2][p1];
+            points[1][p1 + 3 * p2] = should_play[p2][p1] + 1 + p2 * 3;
+        }
+    }
+    return points;
+}();
 
-    for (; begin < end; begin += 4) {
+// Every line is "A X" and a newline, except maybe the last one. Only whole
+// records are read, a stray byte or newline at the end is ignored.
+auto solve_scalar(const char *begin, const char *const end) -> score_t {
+    auto part_1 = int64_t{0};
+    auto part_2 = int64_t{0};
+
+    for (; end - begin >= 3; begin += 4) {
         auto const p1 = begin[0] - 'A';
         auto const p2 = begin[2] - 'X';
 
@@ -119,24 +138,293 @@ auto solve_fast(const char *begin, const char *const end) {
         part_2 += should_play[p2][p1] + 1 + p2 * 3;
     }
 
-    return std::pair{part_1, part_2};
+    return {part_1, part_2};
+}
+
+#if defined(__x86_64__)
+// Both parts' points for line p1 + 3 * p2, twice, pshufb looks up in 16
+// bytes at a time.
+constexpr auto points_table(int part) {
+    auto table = std::array<char, 32>{};
+    for (int line = 0; line < 9; ++line) {
+        table[line] = table[16 + line] = char(line_points[part][line]);
+    }
+    return table;
 }
 
-//static_assert(solve_fast(example.data(), example.data() + example.size()).first == 15);
-//static_assert(solve_fast(example.data(), example.data() + example.size()).second == 12);
+// 32 lines, 128 bytes, per iteration. In every 4 byte lane `A X\n` becomes
+// the line number (0 to 8) in the low byte and 0x80 in the others, so pshufb
+// turns it into the points and zeroes the rest, psadbw then sums the bytes
+// into 64 bit accumulators that can't overflow.
+[[gnu::target("avx2")]] auto solve_avx2(const char *begin,
+                                        const char *const end) -> score_t {
+    auto const letters = _mm256_set1_epi32(0x0a'58'20'41); // "A X\n"
+    auto const low_byte = _mm256_set1_epi32(0xff);
+    auto const others = _mm256_set1_epi32(0x80'80'80'00);
+    auto const zero = _mm256_setzero_si256();
+
+    constexpr auto table_1 = points_table(0);
+    constexpr auto table_2 = points_table(1);
+    auto const points_1 =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(table_1.data()));
+    auto const points_2 =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(table_2.data()));
+
+    auto sum_1 = _mm256_setzero_si256();
+    auto sum_2 = _mm256_setzero_si256();
+
+    for (; end - begin >= 128; begin += 128) {
+        for (int i = 0; i < 128; i += 32) {
+            auto const v = _mm256_sub_epi8(
+                _mm256_loadu_si256(
+                    reinterpret_cast<__m256i const *>(begin + i)),
+                letters);
+            // p1 + 3 * p2, p2 is the third byte
+            auto const p2 = _mm256_srli_epi32(v, 16);
+            auto const p2_times_3 =
+                _mm256_add_epi32(p2, _mm256_add_epi32(p2, p2));
+            auto const line = _mm256_or_si256(
+                _mm256_add_epi32(_mm256_and_si256(v, low_byte), p2_times_3),
+                others);
+
+            auto const line_1 = _mm256_shuffle_epi8(points_1, line);
+            auto const line_2 = _mm256_shuffle_epi8(points_2, line);
+            sum_1 = _mm256_add_epi64(sum_1, _mm256_sad_epu8(line_1, zero));
+            sum_2 = _mm256_add_epi64(sum_2, _mm256_sad_epu8(line_2, zero));
+        }
+    }
 
-int main() {
-    auto then = std::chrono::high_resolution_clock::now();
+    alignas(32) int64_t lanes_1[4];
+    alignas(32) int64_t lanes_2[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes_1), sum_1);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes_2), sum_2);
 
-    auto input = fast_io::native_file_loader("input");
+    auto [part_1, part_2] = solve_scalar(begin, end);
+    for (int i = 0; i < 4; ++i) {
+        part_1 += lanes_1[i];
+        part_2 += lanes_2[i];
+    }
+    return {part_1, part_2};
+}
+#endif
 
-    auto [p1, p2] = solve_fast(input.address_begin, input.address_end);
+// how many times each of the 9 lines shows up, to go with line_points
+using histogram_t = std::array<int64_t, 9>;
 
-    println(p1);
-    println(p2);
+auto histogram_scalar(const char *begin, const char *const end,
+                      histogram_t &counts) -> void {
+    for (; end - begin >= 3; begin += 4) {
+        ++counts[(begin[0] - 'A') + 3 * (begin[2] - 'X')];
+    }
+}
 
-    auto now = std::chrono::high_resolution_clock::now();
-    auto diff = std::chrono::duration<double, std::micro>(now - then);
+#if defined(__x86_64__)
+// 32 lines per iteration. The two letters of every line are gathered into
+// one byte each, key = p1 + 4 * p2 tells the 9 lines apart in a byte, and
+// each key is compared against 8 of the 9 possible ones, matches (-1)
+// subtracted from 8 byte counters. Those are summed up with psadbw before
+// they wrap, the 9th line is whatever's left.
+[[gnu::target("avx2")]] auto histogram_avx2(const char *begin,
+                                            const char *const end,
+                                            histogram_t &counts) -> void {
+    __m256i keys[8];
+    for (int i = 0; i < 8; ++i) {
+        auto const p1 = 'A' + i % 3;
+        auto const p2 = 'X' + i / 3;
+        keys[i] = _mm256_set1_epi8(char(p1 + 4 * p2));
+    }
 
-    println(diff.count(), "us");
+    // in every 16 bytes, the 4 p1 then the 4 p2
+    auto const gather = _mm256_setr_epi8(
+        0, 4, 8, 12, 2, 6, 10, 14, -1, -1, -1, -1, -1, -1, -1, -1, //
+        0, 4, 8, 12, 2, 6, 10, 14, -1, -1, -1, -1, -1, -1, -1, -1);
+    auto const zero = _mm256_setzero_si256();
+
+    while (end - begin >= 128) {
+        // byte counters, 255 rounds at most
+        auto const rounds = std::min<int64_t>((end - begin) / 128, 255);
+        __m256i matches[8]{};
+
+        for (int64_t round = 0; round < rounds; ++round, begin += 128) {
+            __m256i letters[4];
+            for (int i = 0; i < 4; ++i) {
+                letters[i] = _mm256_shuffle_epi8(
+                    _mm256_loadu_si256(
+                        reinterpret_cast<__m256i const *>(begin + 32 * i)),
+                    gather);
+            }
+            // the same line's p1 and p2 end up at the same position
+            auto const low = _mm256_unpacklo_epi32(letters[0], letters[1]);
+            auto const high = _mm256_unpacklo_epi32(letters[2], letters[3]);
+            auto const p1 = _mm256_unpacklo_epi64(low, high);
+            auto const p2 = _mm256_unpackhi_epi64(low, high);
+
+            auto const p2_times_2 = _mm256_add_epi8(p2, p2);
+            auto const key = _mm256_add_epi8(
+                p1, _mm256_add_epi8(p2_times_2, p2_times_2));
+
+            for (int i = 0; i < 8; ++i) {
+                auto const match = _mm256_cmpeq_epi8(key, keys[i]);
+                matches[i] = _mm256_sub_epi8(matches[i], match);
+            }
+        }
+
+        auto seen = int64_t{0};
+        for (int i = 0; i < 8; ++i) {
+            alignas(32) int64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes),
+                               _mm256_sad_epu8(matches[i], zero));
+            for (auto const lane : lanes) {
+                counts[i] += lane;
+                seen += lane;
+            }
+        }
+        counts[8] += rounds * 32 - seen;
+    }
+
+    histogram_scalar(begin, end, counts);
+}
+#endif
+
+// --solver histogram: every thread counts lines over its own 4 byte aligned
+// stretch of the file, the answers are the counts times the points.
+auto solve_histogram(std::string_view input) -> score_t {
+    auto const records = (input.size() + 1) / 4;
+
+    auto const counts = parallel_reduce(
+        records, histogram_t{},
+        [&](size_t first, size_t last) {
+            auto counts = histogram_t{};
+            auto const *const begin = input.data() + first * 4;
+            auto const *const end =
+                input.data() + std::min(last * 4, input.size());
+#if defined(__x86_64__)
+            static auto const avx2 = __builtin_cpu_supports("avx2");
+            if (avx2) {
+                histogram_avx2(begin, end, counts);
+                return counts;
+            }
+#endif
+            histogram_scalar(begin, end, counts);
+            return counts;
+        },
+        [](histogram_t total, histogram_t const &chunk) {
+            for (int i = 0; i < 9; ++i) {
+                total[i] += chunk[i];
+            }
+            return total;
+        });
+
+    auto answer = score_t{};
+    for (int i = 0; i < 9; ++i) {
+        answer.first += counts[i] * line_points[0][i];
+        answer.second += counts[i] * line_points[1][i];
+    }
+    return answer;
+}
+
+// the AVX2 kernel when the cpu has it, checked once
+auto solve_fast(const char *begin, const char *const end) -> score_t {
+#if defined(__x86_64__)
+    static auto const avx2 = __builtin_cpu_supports("avx2");
+    if (avx2) {
+        return solve_avx2(begin, end);
+    }
+#endif
+    return solve_scalar(begin, end);
+}
+
+// The runtime kernels against solve() on the example, repeated so the AVX2
+// ones go through whole 128 byte rounds and a tail too. Not constexpr, so
+// main asserts it in debug builds.
+auto kernels_agree() -> bool {
+    constexpr auto times = 50;
+    auto input = std::string{};
+    for (int i = 0; i < times; ++i) {
+        input.append(example).push_back('\n');
+    }
+    input.pop_back();
+
+    auto const [p1, p2] = solve(parse(example));
+    auto const expected = score_t{p1 * times, p2 * times};
+    auto const *const begin = input.data();
+    auto const *const end = begin + input.size();
+
+    auto const histogram_score = [&](auto &&histogram) {
+        auto counts = histogram_t{};
+        histogram(begin, end, counts);
+        auto answer = score_t{};
+        for (int i = 0; i < 9; ++i) {
+            answer.first += counts[i] * line_points[0][i];
+            answer.second += counts[i] * line_points[1][i];
+        }
+        return answer;
+    };
+
+    auto agree = solve_scalar(begin, end) == expected &&
+                 solve_fast(begin, end) == expected &&
+                 histogram_score(histogram_scalar) == expected &&
+                 solve_histogram(input) == expected;
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx2")) {
+        agree = agree && solve_avx2(begin, end) == expected &&
+                histogram_score(histogram_avx2) == expected;
+    }
+#endif
+    return agree;
+}
+
+// solve_fast steps 4 bytes at a time, so chunks have to be whole lines
+auto solve_stream(block_reader_t &reader) -> score_t {
+    auto part_1 = int64_t{0};
+    auto part_2 = int64_t{0};
+
+    stream_records(reader, "\n"sv, 1, [&](std::string_view chunk) {
+        auto const [p1, p2] =
+            solve_fast(chunk.data(), chunk.data() + chunk.size());
+        part_1 += p1;
+        part_2 += p2;
+    });
+
+    return std::pair{part_1, part_2};
+}
+
+// same, the lines cut in a few chunks per thread
+auto solve_parallel(std::string_view input) -> score_t {
+    auto const chunks = split_records(input, "\n"sv);
+    return parallel_reduce(
+        chunks, score_t{},
+        [](std::string_view chunk) {
+            return solve_fast(chunk.data(), chunk.data() + chunk.size());
+        },
+        [](auto total, auto const &chunk) {
+            return score_t{total.first + chunk.first,
+                           total.second + chunk.second};
+        });
+}
+
+int main(int argc, char **argv) {
+    assert(kernels_agree());
+
+    auto const opts = bench::options_t::from_args(argc, argv, {"--solver"sv});
+    auto const solver = opts.param("--solver"sv).value_or("kernel"sv);
+    if (solver != "kernel"sv && solver != "histogram"sv) {
+        perrln("day02: --solver is kernel or histogram"sv);
+        return 2;
+    }
+
+#if defined(AOC22_CONSTEXPR_SOLVE)
+    constexpr auto answer = solve(parse(embedded_input));
+    if (bench::print_precomputed(opts, "day02"sv, answer)) {
+        return 0;
+    }
+#endif
+
+    benchmark(opts, "day02"sv,
+              [](auto &input) { return std::string_view{input}; },
+              [&](std::string_view input) {
+                  return solver == "histogram"sv ? solve_histogram(input)
+                                                 : solve_parallel(input);
+              },
+              [](auto &reader) { return solve_stream(reader); });
 }
@@ -1,5 +1,4 @@
 #include <algorithm>
-#include <cassert>
 #include <charconv>
 #include <unordered_set>
 #include <chrono>
@@ -32,74 +31,91 @@ wMqvLMZHhHMvwLHjbvcjnnSBnvTQFn
 ttgJtRGJQctTZtZT
 CrZsJsPPZsGzwwsLwLmpwMDw)"sv;
 
-constexpr auto parse(auto &&input) { return input | vw::split("\n"sv); }
-
-constexpr auto split_in_2(std::string_view line) {
-    auto const half = rg::size(line) / 2;
-    return std::pair{line.substr(0, half), line.substr(half)};
+constexpr auto parse(auto &&input) {
+    return line_index_t::lines(std::string_view{input});
 }
 
-constexpr auto to_priority(char ch) -> int {
-    if (ch >= 'a' && ch <= 'z') {
-        return ch - 'a' + 1;
-    } else if (ch >= 'A' && ch <= 'Z') {
-        return ch - 'A' + 26 + 1;
+#if defined(__AVX2__)
+// 4 items per shift, the item bits end up in 4 lanes that are or'ed at the end
+inline auto item_mask_avx2(std::string_view items) -> uint64_t {
+    auto const a = _mm256_set1_epi64x('A');
+    auto const one = _mm256_set1_epi64x(1);
+    auto masks = _mm256_setzero_si256();
+
+    auto i = size_t{0};
+    for (; i + 4 <= items.size(); i += 4) {
+        auto four = uint32_t{};
+        std::memcpy(&four, items.data() + i, 4);
+        auto const chars = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(int(four)));
+        masks = _mm256_or_si256(
+            masks, _mm256_sllv_epi64(one, _mm256_sub_epi64(chars, a)));
     }
 
-    // shouldn't happen
-    return 0;
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), masks);
+    auto mask = lanes[0] | lanes[1] | lanes[2] | lanes[3];
+    for (; i < items.size(); ++i) {
+        mask |= uint64_t{1} << (items[i] - 'A');
+    }
+    return mask;
 }
-
-
-template<int N>
-constexpr auto part2(std::span<std::string_view, N> chunk) {
-    bool maps[chunk.size()][26 * 2 + 1]{};
-
-    for (int i = 0; i < chunk.size(); ++i) {
-        for (auto const idx : chunk[i] | vw::transform(to_priority)) {
-            maps[i][idx] |= true;
-        }
+#endif
+
+// Bit ch - 'A' for every item, 'A' to 'z' fits in 58 bits. What two
+// compartments, or a whole group, have in common is then just an and.
+constexpr auto item_mask(std::string_view items) -> uint64_t {
+#if defined(__AVX2__)
+    if (!std::is_constant_evaluated()) {
+        return item_mask_avx2(items);
     }
-
-    for (int i = 0; i < sizeof(*maps); ++i) {
-        auto contained = true;
-        for(auto const& map : maps) {
-            contained &= map[i];
-        }
-        if(contained) return i;
+#endif
+    auto mask = uint64_t{0};
+    for (auto const ch : items) {
+        mask |= uint64_t{1} << (ch - 'A');
     }
+    return mask;
+}
 
-    return 0;
+// Priorities of the items in `mask` summed up. The puzzle has exactly one
+// in common, other group sizes may have none or a few.
+constexpr auto priority(uint64_t mask) -> int {
+    auto sum = 0;
+    for (; mask; mask &= mask - 1) {
+        // lowercase from bit 32 on
+        auto const bit = std::countr_zero(mask);
+        sum += bit >= 'a' - 'A' ? bit - ('a' - 'A') + 1 : bit + 26 + 1;
+    }
+    return sum;
 }
 
-constexpr auto solve(auto &&lines) {
-    auto part_1 = 0;
-    auto part_2 = 0;
+// Part 2 works on groups of `group_size` elves, 3 in the puzzle. When the
+// lines don't divide evenly, the last group is whatever's left and scores
+// the items those few have in common, the same however the lines are cut.
+constexpr auto solve(auto &&lines, size_t group_size = 3)
+    -> std::pair<int64_t, int64_t> {
+    auto part_1 = int64_t{0};
+    auto part_2 = int64_t{0};
 
-    constexpr auto group_size = 3;
-    std::array<std::string_view, group_size> chunk;
-    int i = 0;
+    auto group = ~uint64_t{0};
+    auto in_group = size_t{0};
 
     for (auto const line : lines) {
-        chunk[i] = line;
-        ++i;
-        if (i == group_size) { // chunk
-            part_2 += part2<group_size>(chunk);
-            i = 0;
-        }
-
-        auto [fst, snd] = split_in_2(line);
-
-        auto it =
-            rg::find_if(fst, [s = snd](auto ch) { return s.contains(ch); });
-
-        if (it != rg::end(fst)) {
-            part_1 += to_priority(*it);
+        auto const half = line.size() / 2;
+        part_1 += priority(item_mask(line.substr(0, half)) &
+                           item_mask(line.substr(half)));
+
+        group &= item_mask(line);
+        if (++in_group == group_size) {
+            part_2 += priority(group);
+            group = ~uint64_t{0};
+            in_group = 0;
         }
     }
 
-    // otherwise handle
-    assert(i == 0);
+    // a short last group
+    if (in_group > 0) {
+        part_2 += priority(group);
+    }
 
     return std::pair{part_1, part_2};
 }
@@ -107,19 +123,54 @@ constexpr auto solve(auto &&lines) {
 static_assert(solve(parse(example)).first == 157);
 static_assert(solve(parse(example2)).second == 70);
 
-int main() {
+// chunks are cut every `group_size` lines, between two groups, so a short
+// last group ends up alone in the last chunk
+auto solve_stream(block_reader_t &reader, size_t group_size)
+    -> std::pair<int64_t, int64_t> {
+    auto part_1 = int64_t{0};
+    auto part_2 = int64_t{0};
 
-    auto then = std::chrono::high_resolution_clock::now();
+    stream_records(reader, "\n"sv, group_size, [&](std::string_view chunk) {
+        auto const [p1, p2] = solve(parse(chunk), group_size);
+        part_1 += p1;
+        part_2 += p2;
+    });
 
-    auto input = fast_io::native_file_loader("input");
+    return std::pair{part_1, part_2};
+}
 
-    auto [p1, p2] = solve(parse(input));
+// the index hands out whole groups for free, so do the chunks
+auto solve_parallel(line_index_t const &lines, size_t group_size)
+    -> std::pair<int64_t, int64_t> {
+    return parallel_reduce(
+        (lines.size() + group_size - 1) / group_size,
+        std::pair<int64_t, int64_t>{},
+        [&](size_t first, size_t last) {
+            auto const end = std::min(last * group_size, lines.size());
+            return solve(rg::subrange(lines.begin() + first * group_size,
+                                      lines.begin() + end),
+                         group_size);
+        },
+        [](auto total, auto const &chunk) {
+            return std::pair{total.first + chunk.first,
+                             total.second + chunk.second};
+        });
+}
 
-    println(p1);
-    println(p2);
+int main(int argc, char **argv) {
+    auto const opts = bench::options_t::from_args(argc, argv, {"--group"sv});
+    auto const group_size =
+        static_cast<size_t>(std::max(1, opts.param("--group"sv, 3)));
 
-    auto now = std::chrono::high_resolution_clock::now();
-    auto diff = std::chrono::duration<double, std::micro>(now - then);
+#if defined(AOC22_CONSTEXPR_SOLVE)
+    constexpr auto answer = solve(parse(embedded_input));
+    if (group_size == 3 && bench::print_precomputed(opts, "day03"sv, answer)) {
+        return 0;
+    }
+#endif
 
-    println(diff.count(), "µs");
-}
\ No newline at end of file
+    benchmark(opts, "day03"sv,
+              [](auto &input) { return parse(input); },
+              [&](auto &lines) { return solve_parallel(lines, group_size); },
+              [&](auto &reader) { return solve_stream(reader, group_size); });
+}
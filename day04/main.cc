@@ -2,6 +2,9 @@
 #include "fast_io.h"
 #include "../lib/utils.hh"
 
+#include <cassert>
+#include <cstdlib>
+#include <optional>
 
 constexpr auto example = R"(2-4,6-8
 2-3,4-5
@@ -65,19 +68,428 @@ constexpr auto solve(Parsed auto &&lines) {
 static_assert(solve(parse(example)).first == 2);
 static_assert(solve(parse(example)).second == 4);
 
-int main() {
+// The fast path: the same pairs, one array per bound (structure of arrays)
+// so solve_sections can compare 8 of them at a time. parse() and solve()
+// above stay as the reference.
+struct sections_t {
+    std::vector<int32_t> start_1;
+    std::vector<int32_t> end_1;
+    std::vector<int32_t> start_2;
+    std::vector<int32_t> end_2;
 
-    auto then = std::chrono::high_resolution_clock::now();
+    auto size() const -> size_t { return start_1.size(); }
+};
+
+using answer_t = std::pair<int64_t, int64_t>;
+
+// "a-b,c-d" lines, by hand: digits until something else, which is skipped.
+// The arrays are the only allocations, sized once, a line is at least 8
+// bytes.
+auto parse_sections(std::string_view input) -> sections_t {
+    auto sections = sections_t{};
+    auto const most = input.size() / 8 + 1;
+    for (auto *bound : {&sections.start_1, &sections.end_1, &sections.start_2,
+                        &sections.end_2}) {
+        bound->reserve(most);
+    }
+
+    auto const *it = input.data();
+    auto const *const end = it + input.size();
+
+    auto const number = [&] {
+        auto value = int32_t{0};
+        for (; it < end && static_cast<unsigned>(*it - '0') < 10; ++it) {
+            value = value * 10 + (*it - '0');
+        }
+        ++it; // '-', ',' or the newline
+        return value;
+    };
+
+    while (it < end) {
+        sections.start_1.push_back(number());
+        sections.end_1.push_back(number());
+        sections.start_2.push_back(number());
+        sections.end_2.push_back(number());
+    }
+
+    return sections;
+}
+
+// Same predicates as solve(): one contains the other, or they overlap at all,
+// which is start_1 <= end_2 and start_2 <= end_1.
+auto solve_sections(sections_t const &sections) -> answer_t {
+    auto part_1 = int64_t{0};
+    auto part_2 = int64_t{0};
+    auto i = size_t{0};
+
+#if defined(__AVX2__)
+    auto const load = [&](std::vector<int32_t> const &bound) {
+        return _mm256_loadu_si256(
+            reinterpret_cast<__m256i const *>(bound.data() + i));
+    };
+
+    for (; i + 8 <= sections.size(); i += 8) {
+        auto const start_1 = load(sections.start_1);
+        auto const end_1 = load(sections.end_1);
+        auto const start_2 = load(sections.start_2);
+        auto const end_2 = load(sections.end_2);
+
+        // everything in terms of >, set where the predicate doesn't hold
+        auto const not_1_in_2 =
+            _mm256_or_si256(_mm256_cmpgt_epi32(start_2, start_1),
+                            _mm256_cmpgt_epi32(end_1, end_2));
+        auto const not_2_in_1 =
+            _mm256_or_si256(_mm256_cmpgt_epi32(start_1, start_2),
+                            _mm256_cmpgt_epi32(end_2, end_1));
+        auto const apart = _mm256_or_si256(_mm256_cmpgt_epi32(start_1, end_2),
+                                           _mm256_cmpgt_epi32(start_2, end_1));
+
+        auto const neither = _mm256_and_si256(not_1_in_2, not_2_in_1);
+        part_1 += 8 - std::popcount(unsigned(
+                          _mm256_movemask_ps(_mm256_castsi256_ps(neither))));
+        part_2 += 8 - std::popcount(unsigned(
+                          _mm256_movemask_ps(_mm256_castsi256_ps(apart))));
+    }
+#endif
+
+    for (; i < sections.size(); ++i) {
+        auto const fst = range_t{sections.start_1[i], sections.end_1[i]};
+        auto const snd = range_t{sections.start_2[i], sections.end_2[i]};
+        part_1 += fst.contains(snd) or snd.contains(fst);
+        part_2 += fst.start <= snd.end and snd.start <= fst.end;
+    }
+
+    return {part_1, part_2};
+}
 
-    auto input = fast_io::native_file_loader("input");
+auto solve_stream(block_reader_t &reader) -> answer_t {
+    auto part_1 = int64_t{0};
+    auto part_2 = int64_t{0};
 
-    auto [p1, p2] = solve(parse(input));
+    stream_records(reader, "\n"sv, 1, [&](std::string_view chunk) {
+        auto const [p1, p2] = solve_sections(parse_sections(chunk));
+        part_1 += p1;
+        part_2 += p2;
+    });
 
-    println(p1);
-    println(p2);
+    return {part_1, part_2};
+}
+
+// the lines cut in a few chunks per thread, each parsed into its own block
+auto parse_parallel(std::string_view input) -> std::vector<sections_t> {
+    auto const chunks = split_records(input, "\n"sv);
+    auto blocks = std::vector<sections_t>(chunks.size());
+    parallel_for(0, chunks.size(),
+                 [&](size_t i) { blocks[i] = parse_sections(chunks[i]); });
+    return blocks;
+}
+
+auto solve_parallel(std::vector<sections_t> const &blocks) -> answer_t {
+    return parallel_reduce(
+        blocks.size(), answer_t{},
+        [&](size_t first, size_t last) {
+            auto answer = answer_t{};
+            for (auto i = first; i < last; ++i) {
+                auto const [p1, p2] = solve_sections(blocks[i]);
+                answer.first += p1;
+                answer.second += p2;
+            }
+            return answer;
+        },
+        [](answer_t total, answer_t const &chunk) {
+            return answer_t{total.first + chunk.first,
+                            total.second + chunk.second};
+        });
+}
+
+// parse_sections and solve_sections against parse() and solve() on the
+// example, repeated so the AVX2 loop gets whole rounds of 8 and a tail. Not
+// constexpr, so main asserts it in debug builds.
+auto kernels_agree() -> bool {
+    constexpr auto times = 5;
+    auto input = std::string{};
+    for (int i = 0; i < times; ++i) {
+        input.append(example).push_back('\n');
+    }
+    input.pop_back();
+
+    auto const [p1, p2] = solve(parse(example));
+    auto const expected = answer_t{p1 * times, p2 * times};
+    return solve_sections(parse_sections(example)) == answer_t{p1, p2} &&
+           solve_sections(parse_sections(input)) == expected &&
+           solve_parallel(parse_parallel(input)) == expected;
+}
 
-    auto now = std::chrono::high_resolution_clock::now();
-    auto diff = std::chrono::duration<double, std::micro>(now - then);
+// Every assignment of the input (two per line), to answer questions about
+// any section without a pass over all of them each time. Counting is two
+// binary searches over the sorted bounds, listing walks an implicit interval
+// tree: the intervals sorted by start, each node the middle of its range and
+// knowing the largest end below it, so whole subtrees that end too early are
+// skipped.
+class interval_index_t {
+  public:
+    explicit interval_index_t(std::vector<sections_t> const &blocks) {
+        auto line = uint32_t{0};
+        for (auto const &block : blocks) {
+            for (size_t i = 0; i < block.size(); ++i, ++line) {
+                by_start.push_back(
+                    {block.start_1[i], block.end_1[i], 2 * line});
+                by_start.push_back(
+                    {block.start_2[i], block.end_2[i], 2 * line + 1});
+            }
+        }
+        rg::sort(by_start, {}, &interval_t::start);
+
+        starts.reserve(by_start.size());
+        ends.reserve(by_start.size());
+        for (auto const &interval : by_start) {
+            starts.push_back(interval.start);
+            ends.push_back(interval.end);
+        }
+        rg::sort(ends);
 
-    println(diff.count(), "µs");
-}
\ No newline at end of file
+        max_end.resize(by_start.size());
+        build(0, by_start.size());
+    }
+
+    // assignments with `section` in them
+    auto count_containing(int32_t section) const -> size_t {
+        return count_overlapping(section, section);
+    }
+
+    // assignments sharing at least a section with first..last (either way
+    // round): all those starting by `last`, but the ones that ended before
+    // `first`, which are among them
+    auto count_overlapping(int32_t first, int32_t last) const -> size_t {
+        if (first > last) {
+            std::swap(first, last);
+        }
+        auto const started = rg::upper_bound(starts, last) - starts.begin();
+        auto const ended = rg::lower_bound(ends, first) - ends.begin();
+        return std::max<ptrdiff_t>(started - ended, 0);
+    }
+
+    // `on_assignment(id)` for each of them, id is 2 * line + which elf. A
+    // subtree is only entered when its largest end reaches `first`, and its
+    // right half when the node starts by `last`, so a path that lists
+    // nothing is at most one walk down: O((k + 1) log n) for k listed, not
+    // the O(log n + k) of a proper interval tree.
+    auto overlapping(int32_t first, int32_t last, auto &&on_assignment) const
+        -> void {
+        if (first > last) {
+            std::swap(first, last);
+        }
+        visit(0, by_start.size(), first, last, on_assignment);
+    }
+
+  private:
+    struct interval_t {
+        int32_t start;
+        int32_t end;
+        uint32_t id;
+    };
+
+    auto build(size_t lo, size_t hi) -> int32_t {
+        if (lo >= hi) {
+            return std::numeric_limits<int32_t>::min();
+        }
+        auto const mid = lo + (hi - lo) / 2;
+        max_end[mid] = std::max(
+            {by_start[mid].end, build(lo, mid), build(mid + 1, hi)});
+        return max_end[mid];
+    }
+
+    auto visit(size_t lo, size_t hi, int32_t first, int32_t last,
+               auto &on_assignment) const -> void {
+        if (lo >= hi) {
+            return;
+        }
+        auto const mid = lo + (hi - lo) / 2;
+        if (max_end[mid] < first) {
+            return;
+        }
+        visit(lo, mid, first, last, on_assignment);
+
+        // everything to the right starts even later
+        if (by_start[mid].start > last) {
+            return;
+        }
+        if (by_start[mid].end >= first) {
+            on_assignment(by_start[mid].id);
+        }
+        visit(mid + 1, hi, first, last, on_assignment);
+    }
+
+    std::vector<interval_t> by_start;
+    std::vector<int32_t> max_end; // of the subtree under each node
+    std::vector<int32_t> starts;  // by_start's, to binary search
+    std::vector<int32_t> ends;    // sorted on their own
+};
+
+// One per line of a --queries file:
+//   overlaps A-B   which assignments share a section with A..B (or B..A)
+//   contains N     how many assignments have section N
+// anything else is an error.
+struct query_t {
+    bool list;
+    int32_t first;
+    int32_t last;
+};
+
+// a whole section number, nothing before or after it
+auto parse_section(std::string_view text) -> std::optional<int32_t> {
+    auto value = int32_t{};
+    auto const end = text.data() + text.size();
+    auto const [ptr, ec] = std::from_chars(text.data(), end, value);
+    if (text.empty() || ec != std::errc{} || ptr != end) {
+        return {};
+    }
+    return value;
+}
+
+auto parse_queries(std::string_view input) -> std::vector<query_t> {
+    auto queries = std::vector<query_t>{};
+
+    for (auto const line : line_index_t::lines(input)) {
+        if (line.empty()) {
+            continue;
+        }
+        if (line.starts_with("overlaps "sv)) {
+            auto const bounds = line.substr("overlaps "sv.size());
+            auto const dash = bounds.find('-');
+            auto const first = parse_section(bounds.substr(0, dash));
+            auto const last = dash == std::string_view::npos
+                                  ? std::nullopt
+                                  : parse_section(bounds.substr(dash + 1));
+            if (first && last) {
+                queries.push_back({true, *first, *last});
+                continue;
+            }
+        } else if (line.starts_with("contains "sv)) {
+            auto const section =
+                parse_section(line.substr("contains "sv.size()));
+            if (section) {
+                queries.push_back({false, *section, *section});
+                continue;
+            }
+        }
+
+        perrln("day04: bad query \""sv, line,
+               "\", expected `overlaps A-B` or `contains N`"sv);
+        std::exit(2);
+    }
+
+    return queries;
+}
+
+// --queries: the index is built once (timed as parse), then every query is
+// answered (solve) and printed. Listed assignments are `line/elf`, from 1.
+auto run_queries(bench::options_t const &opts, std::string_view path) -> void {
+    using bench::phase;
+
+    auto const file = fast_io::native_file_loader(path);
+    auto const queries = parse_queries(std::string_view{file});
+
+    auto recorder = bench::recorder_t{opts};
+    auto const total = opts.warmup + opts.runs;
+
+    for (int run = 0; run < total; ++run) {
+        auto const timed = run >= opts.warmup;
+
+        auto const input = recorder.measure(phase::load, timed, [&] {
+            return fast_io::native_file_loader(opts.input);
+        });
+        auto const index = recorder.measure(phase::parse, timed, [&] {
+            return interval_index_t{parse_parallel(input)};
+        });
+        // only building the index reads the input
+        recorder.input_bytes[size_t(phase::parse)] =
+            std::string_view{input}.size();
+
+        // every query's count, plus the ids of the listing ones one after
+        // the other
+        auto counts = std::vector<size_t>{};
+        auto ids = std::vector<uint32_t>{};
+        recorder.measure(phase::solve, timed, [&] {
+            counts.reserve(queries.size());
+            for (auto const &query : queries) {
+                if (query.list) {
+                    auto const before = ids.size();
+                    index.overlapping(query.first, query.last,
+                                      [&](uint32_t id) { ids.push_back(id); });
+                    counts.push_back(ids.size() - before);
+                } else {
+                    counts.push_back(index.count_containing(query.first));
+                }
+            }
+        });
+
+        if (run + 1 < total) {
+            bench::do_not_optimize(counts);
+            bench::do_not_optimize(ids);
+            continue;
+        }
+
+        // with --json one object per query, like the answers of a solve
+        recorder.measure(phase::print, timed, [&] {
+            auto listed = ids.begin();
+            for (size_t i = 0; i < queries.size(); ++i) {
+                auto const &query = queries[i];
+                if (!query.list) {
+                    if (opts.json) {
+                        println("{\"day\":\"day04\",\"contains\":"sv,
+                                query.first, ",\"count\":"sv, counts[i], "}"sv);
+                    } else {
+                        println("contains "sv, query.first, ": "sv, counts[i]);
+                    }
+                    continue;
+                }
+
+                if (opts.json) {
+                    print("{\"day\":\"day04\",\"overlaps\":["sv,
+                          query.first, ","sv, query.last, "],\"count\":"sv,
+                          counts[i], ",\"assignments\":["sv);
+                } else {
+                    print("overlaps "sv, query.first, "-"sv, query.last,
+                          ": "sv, counts[i]);
+                }
+                // listed in start order, by line reads better
+                std::sort(listed, listed + counts[i]);
+                auto between = opts.json ? ""sv : " "sv;
+                for (auto const id : std::span{listed, counts[i]}) {
+                    auto const quote = opts.json ? "\""sv : ""sv;
+                    print(between, quote, id / 2 + 1, "/"sv, id % 2 + 1,
+                          quote);
+                    between = opts.json ? ","sv : " "sv;
+                }
+                println(opts.json ? "]}"sv : ""sv);
+                listed += counts[i];
+            }
+        });
+    }
+
+    recorder.report("day04"sv);
+}
+
+int main(int argc, char **argv) {
+    assert(kernels_agree());
+
+    auto const opts =
+        bench::options_t::from_args(argc, argv, {"--queries"sv});
+    if (auto const queries = opts.param("--queries"sv)) {
+        run_queries(opts, *queries);
+        return 0;
+    }
+
+#if defined(AOC22_CONSTEXPR_SOLVE)
+    constexpr auto answer = solve(parse(embedded_input));
+    if (bench::print_precomputed(opts, "day04"sv, answer)) {
+        return 0;
+    }
+#endif
+
+    benchmark(opts, "day04"sv,
+              [](auto &input) { return parse_parallel(input); },
+              [](auto &blocks) { return solve_parallel(blocks); },
+              [](auto &reader) { return solve_stream(reader); });
+}
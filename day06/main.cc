@@ -1,6 +1,8 @@
 #include "fast_io.h"
 #include "../lib/utils.hh"
 
+#include <cassert>
+
 constexpr auto example = R"(mjqjpqmgbljsphdztnvjfqwrcgsmlb)"sv;
 
 
@@ -8,66 +10,411 @@ constexpr auto parse(range_of<char> auto &&input) {
     return std::string_view{input};
 }
 
-constexpr auto is_marker(std::string_view str) -> bool {
-    auto bitset = std::array<bool, 'z' - 'a' + 1>{};
-    for(auto const ch : str) {
-        if(bitset[ch - 'a'] == true) {
+// Follows the longest run of distinct bytes ending at the current one, with
+// where each byte was last seen: a repeat moves the start of the run just
+// past its previous occurrence. Every window that fits in the run is a
+// marker, so one pass finds the markers of any number of window sizes, O(1)
+// a byte however big the windows are.
+class marker_detector_t {
+  public:
+    constexpr explicit marker_detector_t(std::span<int const> windows)
+        : windows{windows}, found(windows.size()), pending{windows.size()} {
+        last.fill(-1);
+        update_next();
+    }
+
+    // Feeds the next bytes of the input, false once every window has its
+    // marker and the rest doesn't matter.
+    constexpr auto feed(std::string_view bytes) -> bool {
+        if (pending == 0) {
             return false;
         }
-        bitset[ch - 'a'] = true;
+        for (auto const ch : bytes) {
+            auto &seen = last[static_cast<unsigned char>(ch)];
+            start = std::max(start, seen + 1);
+            seen = position++;
+
+            if (position - start >= next) {
+                record(position - start);
+                if (pending == 0) {
+                    return false;
+                }
+            }
+        }
+        return true;
     }
 
-    return true;
-}
+    // where the first marker of every window ends, 0 if there's none (yet)
+    constexpr auto markers() const -> std::vector<int64_t> const & {
+        return found;
+    }
 
+  private:
+    constexpr auto record(int64_t run) -> void {
+        for (size_t i = 0; i < windows.size(); ++i) {
+            if (found[i] == 0 && windows[i] <= run) {
+                found[i] = position;
+                --pending;
+            }
+        }
+        update_next();
+    }
+
+    // the smallest window still without a marker
+    constexpr auto update_next() -> void {
+        next = std::numeric_limits<int64_t>::max();
+        for (size_t i = 0; i < windows.size(); ++i) {
+            if (found[i] == 0) {
+                next = std::min<int64_t>(next, windows[i]);
+            }
+        }
+    }
+
+    std::array<int64_t, 256> last;
+    int64_t start = 0;
+    int64_t position = 0;
+
+    std::span<int const> windows;
+    std::vector<int64_t> found;
+    size_t pending;
+    int64_t next;
+};
+
+constexpr auto find_markers(std::string_view input,
+                            std::span<int const> windows)
+    -> std::vector<int64_t> {
+    auto detector = marker_detector_t{windows};
+    // markers are letters only
+    detector.feed(input.substr(0, input.find('\n')));
+    return detector.markers();
+}
 
 constexpr auto solve(std::string_view input) -> std::pair<int, int> {
-    constexpr auto window_size_p1 = 4;
-    constexpr auto window_size_p2 = 14;
-
-    auto part_1 = std::optional<int>{};
-    auto part_2 = std::optional<int>{};
-    
-    for(int i = 0; i < input.size() - window_size_p2; ++i) {
-
-        auto start_if_marker = [=](auto window_size) -> std::optional<int> {
-            if(is_marker(input.substr(i, window_size)))
-                return i + window_size;
-            return {};
-        };
-
-        if(!part_1){
-            part_1 = start_if_marker(window_size_p1);
-            // just in case they share the same window
-            part_2 = start_if_marker(window_size_p2); 
+    constexpr auto windows = std::array{4, 14};
+    auto const markers = find_markers(input, windows);
+    return std::pair{static_cast<int>(markers[0]),
+                     static_cast<int>(markers[1])};
+}
+
+static_assert(solve(parse(example)).first == 7);
+static_assert(solve(parse(example)).second == 19);
+
+// lib.fut's is_marker: a letter is the bit 1 << (ch - 'a'), the window is a
+// marker when OR-ing them keeps all of its letters. Anything but a letter
+// has no bit, a window with one is no marker.
+constexpr auto is_marker(std::string_view window) -> bool {
+    auto letters = uint32_t{0};
+    for (auto const ch : window) {
+        if (ch < 'a' || ch > 'z') {
+            return false;
         }
-        else if(!part_2) {
-            part_2 = start_if_marker(window_size_p2);
+        letters |= uint32_t{1} << (ch - 'a');
+    }
+    return std::popcount(letters) == static_cast<int>(window.size());
+}
+
+static_assert(is_marker("abcd"sv) && !is_marker("abca"sv));
+static_assert(!is_marker("abcA"sv) && !is_marker("ab{}"sv));
+
+// where the first marker of `window` letters ends, 0 if there's none, trying
+// every offset from `from` on
+auto first_marker_scalar(std::string_view input, size_t window, size_t from)
+    -> int64_t {
+    for (auto i = from; i + window <= input.size(); ++i) {
+        if (is_marker(input.substr(i, window))) {
+            return i + window;
         }
-        else { // solved
-            break;
+    }
+    return 0;
+}
+
+#if defined(__x86_64__)
+// Same, 16 offsets at a time, one per 32 bit lane of two vectors: lane k ORs
+// the bits of the window starting at i + k, byte by byte. AVX2 has no
+// popcount, so instead of counting the bits every lane keeps those it saw
+// twice, a window is a marker when there are none. Stops at the first 16
+// with a marker. Bytes that aren't letters would get nonsense bits, 16
+// offsets whose windows reach one go to the scalar kernel instead.
+[[gnu::target("avx2")]] auto first_marker_avx2(std::string_view input,
+                                               size_t window, size_t from)
+    -> int64_t {
+    auto const a = _mm256_set1_epi32('a');
+    auto const one = _mm256_set1_epi32(1);
+    auto const zero = _mm256_setzero_si256();
+    auto const *const data = input.data();
+
+    // where the last byte that isn't a letter is, of those checked so far
+    auto outside_at = int64_t{-1};
+    auto const check = [&](size_t at) {
+        auto const bytes =
+            _mm_loadu_si128(reinterpret_cast<__m128i const *>(data + at));
+        // below 'a' wraps around to above 'z', one unsigned compare does both
+        auto const past_z = _mm_subs_epu8(
+            _mm_sub_epi8(bytes, _mm_set1_epi8('a')), _mm_set1_epi8(25));
+        auto const outside = static_cast<uint32_t>(~_mm_movemask_epi8(
+                                 _mm_cmpeq_epi8(past_z, _mm_setzero_si128()))) &
+                             0xffff;
+        if (outside != 0) {
+            outside_at = at + 31 - std::countl_zero(outside);
+        }
+    };
+
+    auto i = from;
+    // the first window - 1 bytes, then every block checks the 16 its windows
+    // reach past the previous one's
+    for (size_t k = 0; k + 1 < window && i + 15 + window <= input.size();
+         k += 16) {
+        check(i + k);
+    }
+    for (; i + 15 + window <= input.size(); i += 16) {
+        check(i + window - 1);
+        if (outside_at >= static_cast<int64_t>(i)) {
+            auto const block = input.substr(0, i + 15 + window);
+            auto const found = first_marker_scalar(block, window, i);
+            if (found != 0) {
+                return found;
+            }
+            continue;
+        }
+
+        // the two halves are independent, which hides the latency of the
+        // seen -> twice chain
+        auto seen_lo = _mm256_setzero_si256();
+        auto seen_hi = _mm256_setzero_si256();
+        auto twice_lo = _mm256_setzero_si256();
+        auto twice_hi = _mm256_setzero_si256();
+        for (size_t k = 0; k < window; ++k) {
+            auto const bytes = _mm_loadu_si128(
+                reinterpret_cast<__m128i const *>(data + i + k));
+            auto const bits_lo = _mm256_sllv_epi32(
+                one, _mm256_sub_epi32(_mm256_cvtepu8_epi32(bytes), a));
+            auto const bits_hi = _mm256_sllv_epi32(
+                one, _mm256_sub_epi32(
+                         _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)), a));
+            twice_lo =
+                _mm256_or_si256(twice_lo, _mm256_and_si256(seen_lo, bits_lo));
+            twice_hi =
+                _mm256_or_si256(twice_hi, _mm256_and_si256(seen_hi, bits_hi));
+            seen_lo = _mm256_or_si256(seen_lo, bits_lo);
+            seen_hi = _mm256_or_si256(seen_hi, bits_hi);
+        }
+
+        auto const markers =
+            _mm256_movemask_ps(
+                _mm256_castsi256_ps(_mm256_cmpeq_epi32(twice_lo, zero))) |
+            _mm256_movemask_ps(
+                _mm256_castsi256_ps(_mm256_cmpeq_epi32(twice_hi, zero)))
+                << 8;
+        if (markers != 0) {
+            return i + std::countr_zero(static_cast<unsigned>(markers)) +
+                   window;
         }
     }
 
-    return std::pair{*part_1, *part_2};
+    return first_marker_scalar(input, window, i);
 }
+#endif
 
-static_assert(solve(parse(example)).first == 7);
-static_assert(solve(parse(example)).second == 19);
+// the AVX2 kernel when the cpu has it, checked once
+auto first_marker(std::string_view input, size_t window, size_t from)
+    -> int64_t {
+#if defined(__x86_64__)
+    static auto const avx2 = __builtin_cpu_supports("avx2");
+    if (avx2) {
+        return first_marker_avx2(input, window, from);
+    }
+#endif
+    return first_marker_scalar(input, window, from);
+}
+
+// whether `bytes` are all 'a' to 'z', 16 at a time
+auto all_letters(std::string_view bytes) -> bool {
+    auto i = size_t{0};
+#if defined(__x86_64__)
+    auto const a = _mm_set1_epi8('a');
+    auto const past_z = _mm_set1_epi8('z' - 'a');
+    auto outside = _mm_setzero_si128();
+    for (; i + 16 <= bytes.size(); i += 16) {
+        auto const chunk = _mm_loadu_si128(
+            reinterpret_cast<__m128i const *>(bytes.data() + i));
+        // below 'a' wraps around to above 'z', one unsigned compare does both
+        outside = _mm_or_si128(
+            outside, _mm_subs_epu8(_mm_sub_epi8(chunk, a), past_z));
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(outside, _mm_setzero_si128())) !=
+        0xffff) {
+        return false;
+    }
+#endif
+    return rg::all_of(bytes.substr(i),
+                      [](char ch) { return ch >= 'a' && ch <= 'z'; });
+}
+
+// The first marker of every window, searching for each on its own with
+// `search(input, window, from)`. Windows go from small to big: a marker
+// starts with a marker of any smaller window, so each search starts where
+// the last one found something. Only for letters, and windows that fit in
+// 32 bits, anything else goes through the detector.
+auto find_markers_with(std::string_view input, std::span<int const> windows,
+                       auto &&search) -> std::vector<int64_t> {
+    input = input.substr(0, input.find('\n'));
+    if (rg::any_of(windows, [](int window) { return window > 32; }) ||
+        !all_letters(input)) {
+        return find_markers(input, windows);
+    }
+
+    auto order = std::vector<size_t>(windows.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    rg::sort(order, {}, [&](size_t i) { return windows[i]; });
+
+    auto found = std::vector<int64_t>(windows.size());
+    auto from = size_t{0};
+    for (auto const i : order) {
+        auto const window = static_cast<size_t>(windows[i]);
+        found[i] = search(input, window, from);
+        if (found[i] == 0) {
+            break; // nor for any bigger window
+        }
+        from = found[i] - window;
+    }
+    return found;
+}
+
+auto find_markers_fast(std::string_view input, std::span<int const> windows)
+    -> std::vector<int64_t> {
+    return find_markers_with(input, windows, first_marker);
+}
+
+// start offsets a worker tries at once, between two looks at what the others
+// found
+constexpr auto marker_block = size_t{1} << 18;
+
+// first_marker on the whole pool. The start offsets are cut in blocks that
+// workers claim in order, each searching its block's windows (so it reads
+// window - 1 bytes into the next block). The earliest marker found so far is
+// an atomic min, a worker stops as soon as its next block starts after it:
+// nothing there can come first, and every block before it has been claimed
+// already, so the result is the same as a sequential search.
+auto first_marker_parallel(std::string_view input, size_t window, size_t from)
+    -> int64_t {
+    if (input.size() < from + window) {
+        return 0;
+    }
+    auto const end = input.size() - window + 1; // past the last start
+    auto const blocks = (end - from + marker_block - 1) / marker_block;
+
+    auto &pool = task_pool_t::global();
+    if (pool.thread_count() == 1 || blocks <= 1) {
+        return first_marker(input, window, from);
+    }
+
+    auto next = std::atomic<size_t>{0};
+    auto earliest = std::atomic<size_t>{std::numeric_limits<size_t>::max()};
 
-int main() {
+    pool.run(static_cast<size_t>(pool.thread_count()), [&](size_t) {
+        for (auto block = next.fetch_add(1); block < blocks;
+             block = next.fetch_add(1)) {
+            auto const first = from + block * marker_block;
+            if (first >= earliest.load(std::memory_order_relaxed)) {
+                return;
+            }
+            auto const last = std::min(first + marker_block, end);
 
-    auto then = std::chrono::high_resolution_clock::now();
+            auto const found =
+                first_marker(input.substr(0, last + window - 1), window, first);
+            if (found != 0) {
+                auto const start = static_cast<size_t>(found) - window;
+                auto seen = earliest.load();
+                while (start < seen &&
+                       !earliest.compare_exchange_weak(seen, start)) {
+                }
+                return; // its later blocks can't do better
+            }
+        }
+    });
+
+    auto const start = earliest.load();
+    return start == std::numeric_limits<size_t>::max()
+               ? 0
+               : static_cast<int64_t>(start + window);
+}
+
+auto find_markers_parallel(std::string_view input,
+                           std::span<int const> windows)
+    -> std::vector<int64_t> {
+    return find_markers_with(input, windows, first_marker_parallel);
+}
+
+// The kernels can't be static_asserted: scalar, AVX2 (when the cpu has it)
+// and the detector, for every window size they handle.
+auto kernels_agree(std::string_view input) -> bool {
+    constexpr auto windows = std::array{4, 14, 32};
+    auto const expected = find_markers(input, windows);
+    auto agree = find_markers_with(input, windows, first_marker_scalar) ==
+                 expected;
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx2")) {
+        agree &= find_markers_with(input, windows, first_marker_avx2) ==
+                 expected;
+        // below find_markers_with's check for letters, the two on their own
+        for (auto const window : windows) {
+            agree &= first_marker_avx2(input, window, 0) ==
+                     first_marker_scalar(input, window, 0);
+        }
+    }
+#endif
+    return agree;
+}
+
+// Same, block by block. The detector carries over from one block to the
+// next, so there's nothing to overlap.
+auto solve_stream(block_reader_t &reader, std::span<int const> windows)
+    -> std::vector<int64_t> {
+    auto detector = marker_detector_t{windows};
 
-    auto input = fast_io::native_file_loader("input");
+    for (auto block = reader.next(); !block.empty(); block = reader.next()) {
+        auto const end = block.find('\n');
+        if (!detector.feed(block.substr(0, end)) ||
+            end != std::string_view::npos) {
+            break;
+        }
+    }
+
+    return detector.markers();
+}
 
-    auto [p1, p2] = solve(parse(input));
+// --windows 4,14,100: the first marker of every one of these sizes, one per
+// line, instead of parts 1 and 2
+auto parse_windows(std::string_view list) -> std::vector<int> {
+    auto windows = std::vector<int>{};
+    for (auto const size : list | vw::split(","sv)) {
+        windows.push_back(
+            std::max(1, to_int(std::string_view{size.begin(), size.end()})));
+    }
+    return windows;
+}
 
-    println(p1);
-    println(p2);
+int main(int argc, char **argv) {
+    assert(kernels_agree(example));
+    assert(kernels_agree("mjqjpqmgbljsphdZtnvjfqwrcgsmlbMJQJmjqjpqmgbljs"sv));
 
-    auto now = std::chrono::high_resolution_clock::now();
-    auto diff = std::chrono::duration<double, std::micro>(now - then);
+    auto const opts =
+        bench::options_t::from_args(argc, argv, {"--windows"sv});
+    auto const windows =
+        parse_windows(opts.param("--windows"sv).value_or("4,14"sv));
 
-    println(diff.count(), "µs");
-}
\ No newline at end of file
+#if defined(AOC22_CONSTEXPR_SOLVE)
+    constexpr auto answer = solve(parse(embedded_input));
+    if (!opts.param("--windows"sv) &&
+        bench::print_precomputed(opts, "day06"sv, answer)) {
+        return 0;
+    }
+#endif
+
+    benchmark(
+        opts, "day06"sv, [](auto &input) { return parse(input); },
+        [&](std::string_view input) {
+            return find_markers_parallel(input, windows);
+        },
+        [&](auto &reader) { return solve_stream(reader, windows); });
+}
@@ -1,38 +1,106 @@
-#include "lib.h"
 #include "fast_io.h"
-#include <cstddef>
-#include <vector>
+#include "../lib/utils.hh"
+
 #include <chrono>
-#include <span>
-#include <string_view>
 #include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+#include "lib.h"
+
+#if !defined(AOC22_FUTHARK_BACKEND)
+#define AOC22_FUTHARK_BACKEND "unknown"
+#endif
+
+// One context for every input and every run. Setting it up (threads, and on
+// a GPU compiling the kernels) costs way more than a solve, so it's done and
+// timed once, on its own, then parse copies the input over and solve only
+// runs the entry point.
+class context_t {
+  public:
+    explicit context_t(int threads) {
+        config = futhark_context_config_new();
+        futhark_context_config_set_cache_file(config, "futhark.cache");
+#if defined(AOC22_FUTHARK_THREADS)
+        futhark_context_config_set_num_threads(config, threads);
+#else
+        (void)threads;
+#endif
+        context = futhark_context_new(config);
+        fail_on(futhark_context_sync(context));
+    }
+
+    context_t(context_t const &) = delete;
+    auto operator=(context_t const &) -> context_t & = delete;
 
-using namespace std::string_view_literals;
+    ~context_t() {
+        futhark_context_free(context);
+        futhark_context_config_free(config);
+    }
 
-int main() {
-    // i won't count the initialization as part of the runtime, although it sure is
-    auto *cfg = futhark_context_config_new();
-    futhark_context_config_set_cache_file(cfg, "futhark.cache");
-    auto* context = futhark_context_new(cfg);
+    auto get() const -> futhark_context * { return context; }
 
-    auto then = std::chrono::high_resolution_clock::now();
+    // futhark calls return non zero when they failed, the context knows why
+    auto fail_on(int error) const -> void {
+        auto *const message = futhark_context_get_error(context);
+        if (error == 0 && message == nullptr) {
+            return;
+        }
+        perrln("day06_futhark: "sv,
+               std::string_view{message ? message : "futhark call failed"});
+        std::free(message);
+        std::exit(1);
+    }
 
-    auto file = fast_io::native_file_loader{"input"};
-    auto* arr = futhark_new_u8_1d(context, reinterpret_cast<uint8_t*>(file.data()), file.size());
+  private:
+    futhark_context_config *config;
+    futhark_context *context;
+};
+
+struct array_deleter_t {
+    context_t const *context;
+    auto operator()(futhark_u8_1d *array) const -> void {
+        context->fail_on(futhark_free_u8_1d(context->get(), array));
+    }
+};
+
+using array_t = std::unique_ptr<futhark_u8_1d, array_deleter_t>;
+
+// the letters (lib.fut doesn't know about the newline), wherever the backend
+// wants them
+auto parse(context_t const &context, std::string_view input) -> array_t {
+    input = input.substr(0, input.find('\n'));
+    auto *const array = futhark_new_u8_1d(
+        context.get(), reinterpret_cast<uint8_t const *>(input.data()),
+        static_cast<int64_t>(input.size()));
+    context.fail_on(array == nullptr);
+    // the copy may be asynchronous, it belongs in parse
+    context.fail_on(futhark_context_sync(context.get()));
+    return array_t{array, array_deleter_t{&context}};
+}
+
+auto solve(context_t const &context, array_t const &input)
+    -> std::pair<int64_t, int64_t> {
+    auto part_1 = int64_t{0};
+    auto part_2 = int64_t{0};
+    context.fail_on(
+        futhark_entry_solve(context.get(), &part_1, &part_2, input.get()));
+    context.fail_on(futhark_context_sync(context.get()));
+    return std::pair{part_1, part_2};
+}
 
+int main(int argc, char **argv) {
+    auto const opts = bench::options_t::from_args(argc, argv);
 
+    auto const then = std::chrono::high_resolution_clock::now();
+    auto const context = context_t{opts.threads};
+    auto const setup = std::chrono::duration<double, std::micro>(
+        std::chrono::high_resolution_clock::now() - then);
+    perrln("day06_futhark "sv, AOC22_FUTHARK_BACKEND ""sv,
+           " context setup: "sv, bench::rounded(setup.count()), "us"sv);
 
-    long part1;
-    long part2;
-    futhark_entry_solve(context, &part1, &part2, arr);
-    
-    println(part1);
-    println(part2);
-    auto now = std::chrono::high_resolution_clock::now();
-    auto diff = std::chrono::duration<double, std::micro>(now - then);
-    println(diff.count(), "µs");
-    
-    futhark_free_u8_1d(context, arr);
-    futhark_context_free(context);
-    futhark_context_config_free(cfg);
+    benchmark(
+        opts, "day06_futhark"sv,
+        [&](auto &input) { return parse(context, std::string_view{input}); },
+        [&](array_t const &input) { return solve(context, input); });
 }
@@ -29,7 +29,7 @@ $ ls
 
 constexpr auto parse(std::string_view input)
     -> range_of<std::string_view> auto {
-    return input | vw::split("\n"sv);
+    return line_index_t::lines(input);
 }
 
 struct node_t;
@@ -38,10 +38,13 @@ struct file_node_t {
     size_t size;
 };
 
+using child_t = std::pair<std::string_view, node_t>;
+using children_t = std::vector<child_t, arena_allocator<child_t>>;
+
 struct dir_node_t {
     dir_node_t *parent;
     size_t cached_size;
-    std::vector<std::pair<std::string_view, node_t>> children;
+    children_t children;
 
     [[gnu::pure]] constexpr auto size() const -> size_t;
 
@@ -107,11 +110,14 @@ auto tree(dir_node_t const &root, int indent = 0) -> void {
     }
 }
 
-constexpr auto solve(range_of<std::string_view> auto &&input) -> std::pair<int, int> {
+// the whole tree is allocated from `resource` if given
+constexpr auto solve(range_of<std::string_view> auto &&input,
+                     std::pmr::memory_resource *resource = nullptr)
+    -> std::pair<int, int> {
 
     auto part_1 = 0;
 
-    auto root_node = dir_node_t{};
+    auto root_node = dir_node_t{.children = children_t(resource)};
 
     auto curr_dir = &root_node;
 
@@ -144,7 +150,8 @@ constexpr auto solve(range_of<std::string_view> auto &&input) -> std::pair<int,
 
             if (fst == "dir"sv) {
                 auto node = node_t {
-                    .node = dir_node_t{.parent = curr_dir},
+                    .node = dir_node_t{.parent = curr_dir,
+                                       .children = children_t(resource)},
                 };
 
                 curr_dir->children.emplace_back(std::make_pair(name, node));
@@ -190,22 +197,26 @@ constexpr auto solve(range_of<std::string_view> auto &&input) -> std::pair<int,
     return std::pair{part_1, smallest_to_remove};
 }
 
-int main() {
+int main(int argc, char **argv) {
 
     static_assert(solve(parse(example)).first == 95437);
     static_assert(solve(parse(example)).second == 24933642);
 
-    auto then = std::chrono::high_resolution_clock::now();
-
-    auto input = fast_io::native_file_loader("input");
-
-    auto [p1, p2] = solve(parse(input));
+    auto const opts = bench::options_t::from_args(argc, argv);
 
-    println(p1);
-    println(p2);
-
-    auto now = std::chrono::high_resolution_clock::now();
-    auto diff = std::chrono::duration<double, std::micro>(now - then);
-
-    println(diff.count(), "µs");
+#if defined(AOC22_CONSTEXPR_SOLVE)
+    constexpr auto answer = solve(parse(embedded_input));
+    if (bench::print_precomputed(opts, "day07"sv, answer)) {
+        return 0;
+    }
+#endif
+
+    benchmark(opts, "day07"sv,
+              [](auto &input) { return parse(input); },
+              [](auto &lines) {
+                  // one per thread for --batch
+                  thread_local auto arena = arena_t{};
+                  arena.release();
+                  return solve(lines, arena.resource());
+              });
 }
\ No newline at end of file
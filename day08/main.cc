@@ -12,10 +12,12 @@ R"(30373
 
 constexpr auto parse(std::string_view input)
     -> range_of<std::string_view> auto {
-    return to_vec<std::string_view>(input | vw::split("\n"sv));
+    return line_index_t::lines(input);
 }
 
-constexpr auto scenic_score(std::span<std::string_view const> trees, int i, int j) -> std::pair<int, bool> {
+using trees_t = line_index_t;
+
+constexpr auto scenic_score(trees_t const &trees, int i, int j) -> std::pair<int, bool> {
     auto const directions = {
         std::pair{-1, 0}, 
         std::pair{0, -1},
@@ -59,15 +61,16 @@ constexpr auto scenic_score(std::span<std::string_view const> trees, int i, int
     return {score, is_visible_from_outside};
 }
 
-constexpr auto solve(std::span<std::string_view const> trees) -> std::pair<int, int> {
+// rows [first, last) only, so they can be split between threads
+constexpr auto solve_rows(trees_t const &trees, int first, int last)
+    -> std::pair<int, int> {
 
     auto part_1 = 0;
     auto part_2 = 0;
 
-    auto rows = trees.size();
     auto columns = trees.front().size();
 
-    for(int i = 0; i < rows; ++i) {
+    for(int i = first; i < last; ++i) {
         for(int j = 0; j < columns; ++j) {
             auto const [score, visible] = scenic_score(trees, i, j);
 
@@ -82,25 +85,41 @@ constexpr auto solve(std::span<std::string_view const> trees) -> std::pair<int,
     return std::pair{part_1, part_2};
 }
 
+constexpr auto solve(trees_t const &trees) -> std::pair<int, int> {
+    return solve_rows(trees, 0, trees.size());
+}
+
+// every tree is scored on its own, the rows are spread over the pool
+auto solve_parallel(trees_t const &trees) -> std::pair<int, int> {
+    return parallel_reduce(
+        trees.size(), std::pair{0, 0},
+        [&](size_t first, size_t last) {
+            return solve_rows(trees, first, last);
+        },
+        [](auto total, auto const &rows) {
+            return std::pair{total.first + rows.first,
+                             std::max(total.second, rows.second)};
+        });
+}
+
 static_assert(solve(parse(example)).first == 21);
 static_assert(solve(parse(example)).second == 8 );
 
-int main() {
+int main(int argc, char **argv) {
 
     assert(solve(parse(example)).first ==21);
     assert(solve(parse(example)).second == 8);
 
-    auto then = std::chrono::high_resolution_clock::now();
+    auto const opts = bench::options_t::from_args(argc, argv);
 
-    auto input = fast_io::native_file_loader("input");
-
-    auto [p1, p2] = solve(parse(input));
-
-    println(p1);
-    println(p2);
-
-    auto now = std::chrono::high_resolution_clock::now();
-    auto diff = std::chrono::duration<double, std::micro>(now - then);
+#if defined(AOC22_CONSTEXPR_SOLVE)
+    constexpr auto answer = solve(parse(embedded_input));
+    if (bench::print_precomputed(opts, "day08"sv, answer)) {
+        return 0;
+    }
+#endif
 
-    println(diff.count(), "µs");
+    benchmark(opts, "day08"sv,
+              [](auto &input) { return parse(input); },
+              [](auto &trees) { return solve_parallel(trees); });
 }
\ No newline at end of file
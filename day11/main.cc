@@ -205,14 +205,9 @@ auto solve(std::vector<monkey_t> monkeys) -> std::pair<uint64_t, uint64_t> {
 static_assert(solve_impl<false>(parse(example), 20) == 10605);
 //static_assert(solve_impl<true>(parse(example), 10'000) == 2713310158ll); "too many iterations for constexpr"
 
-int main() {
+int main(int argc, char **argv) {
 
-    benchmark([]() {
-        auto input = fast_io::native_file_loader("input");
-
-        auto [p1, p2] = solve(parse(input));
-
-        println(p1);
-        println(p2);
-    });
+    benchmark(bench::options_t::from_args(argc, argv), "day11"sv,
+              [](auto &input) { return parse(input); },
+              [](auto &monkeys) { return solve(monkeys); });
 }
\ No newline at end of file
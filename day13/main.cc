@@ -34,14 +34,16 @@ constexpr auto example =
 [1,[2,[3,[4,[5,6,0]]]],8,9])"sv;
 
 struct value_t {
-    std::variant<int64_t, std::vector<value_t>> val;
+    using list_t = std::vector<value_t, arena_allocator<value_t>>;
+
+    std::variant<int64_t, list_t> val;
 
     constexpr auto as_span() const -> std::span<value_t const> {
         if (auto ptr = std::get_if<int64_t>(&val)) {
             return {this, 1};
         }
 
-        return std::get<std::vector<value_t>>(val);
+        return std::get<list_t>(val);
     }
 
     constexpr auto to_string() const -> std::string {
@@ -68,7 +70,7 @@ struct value_t {
     }
 
     template <std::convertible_to<decltype(val)> T>
-    constexpr auto operator<=>(T value) {
+    constexpr auto operator<=>(T value) const {
         return *this <=> value_t::from(value);
     }
 
@@ -105,14 +107,18 @@ struct value_t {
         }
     }
 
-    static constexpr auto parse(std::string_view str) -> value_t {
+    // lists are allocated from `resource` if given
+    static constexpr auto parse(std::string_view str,
+                                std::pmr::memory_resource *resource = nullptr)
+        -> value_t {
         if (std::is_constant_evaluated()) {
-            return parse_manually(str);
+            return parse_manually(str, resource);
         }
-        return parse_as_json(str);
+        return parse_as_json(str, resource);
     }
 
-    static auto parse_as_json(std::string_view str) -> value_t {
+    static auto parse_as_json(std::string_view str,
+                              std::pmr::memory_resource *resource) -> value_t {
 
         auto parser = simdjson::ondemand::parser{};
         auto json = simdjson::padded_string{str};
@@ -123,14 +129,18 @@ struct value_t {
         if (ec)
             throw "nope";
 
-        return from_json_value(doc.get_value().take_value());
+        return from_json_value(doc.get_value().take_value(), resource);
     }
 
-    static constexpr auto parse_manually(std::string_view input) -> value_t {
-        return parse_value_impl(&*input.begin(), &*input.end()).first;
+    static constexpr auto parse_manually(std::string_view input,
+                                         std::pmr::memory_resource *resource)
+        -> value_t {
+        return parse_value_impl(&*input.begin(), &*input.end(), resource)
+            .first;
     }
 
-    static constexpr auto parse_value_impl(char const *begin, char const *end)
+    static constexpr auto parse_value_impl(char const *begin, char const *end,
+                                           std::pmr::memory_resource *resource)
         -> std::pair<value_t, char const *> {
 
         if (begin == end)
@@ -138,7 +148,7 @@ struct value_t {
 
         if (*begin == '[') {
             ++begin;
-            auto vec = std::vector<value_t>{};
+            auto vec = list_t(resource);
 
             if (begin == end)
                 abort();
@@ -151,7 +161,7 @@ struct value_t {
                 if (*begin == ']')
                     return {value_t::from(vec), begin + 1};
 
-                auto const [val, ptr] = parse_value_impl(begin, end);
+                auto const [val, ptr] = parse_value_impl(begin, end, resource);
 
                 begin = ptr;
                 vec.emplace_back(std::move(val));
@@ -172,13 +182,15 @@ struct value_t {
         }
     }
 
-    static value_t from_json_value(simdjson::ondemand::value val) {
+    static value_t from_json_value(simdjson::ondemand::value val,
+                                   std::pmr::memory_resource *resource) {
 
         switch (val.type()) {
         case simdjson::fallback::ondemand::json_type::array: {
-            auto vec = std::vector<value_t>{};
+            auto vec = list_t(resource);
             for (auto value : val.get_array()) {
-                vec.emplace_back(value_t::from_json_value(value.value()));
+                vec.emplace_back(
+                    value_t::from_json_value(value.value(), resource));
             }
 
             return value_t::from(vec);
@@ -194,17 +206,28 @@ struct value_t {
 };
 
 using parsed_t = std::array<value_t, 2>;
-
-constexpr auto parse(std::string_view input) {
-    auto groups = input | vw::split("\n\n"sv) | vw::transform([](auto &&group) {
-                      return to_array<2>(group | vw::split("\n"sv) |
-                                         vw::transform(value_t::parse));
-                  });
+using pairs_t = std::vector<parsed_t, arena_allocator<parsed_t>>;
+
+// The pairs and their packets are allocated from `resource` if given, all
+// of it here so the parse phase is the whole parse.
+constexpr auto parse(std::string_view input,
+                     std::pmr::memory_resource *resource = nullptr)
+    -> pairs_t {
+    auto const parse_value = [=](auto &&line) {
+        return value_t::parse(line, resource);
+    };
+
+    auto groups = pairs_t(resource);
+    for (auto &&group : input | vw::split("\n\n"sv)) {
+        groups.push_back(to_array<2>(group | vw::split("\n"sv) |
+                                     vw::transform(parse_value)));
+    }
 
     return groups;
 }
 
-constexpr auto solve(range_of<parsed_t> auto groups) -> std::pair<int, int> {
+constexpr auto solve(range_of<parsed_t> auto const &groups)
+    -> std::pair<int, int> {
     auto part_1 = 0;
 
     auto first_sentinel = 1;                   // will be after the
@@ -237,19 +260,19 @@ constexpr auto solve(range_of<parsed_t> auto groups) -> std::pair<int, int> {
 // variant isn't constexpr it seems
 //static_assert(solve(parse(example)).first == 13);
 
-int main() {
+int main(int argc, char **argv) {
     auto test = "[1,[2,[3,[4,[5,6,7]]]],8,9]"sv;
     auto funny = value_t::parse(test);
 
     auto parsed = parse(example);
     auto solved = solve(parsed);
 
-    benchmark([]() {
-        auto input = fast_io::native_file_loader("input");
-
-        auto [p1, p2] = solve(parse(input));
-
-        println(p1);
-        println(p2);
-    });
+    benchmark(bench::options_t::from_args(argc, argv), "day13"sv,
+              [](auto &input) {
+                  // one per thread for --batch
+                  thread_local auto arena = arena_t{};
+                  arena.release();
+                  return parse(input, arena.resource());
+              },
+              [](auto &groups) { return solve(groups); });
 }
\ No newline at end of file
@@ -5,7 +5,6 @@
 #include <concepts>
 #include <cstddef>
 #include <ranges>
-#include <unordered_map>
 #include <utility>
 #include <variant>
 
@@ -26,73 +25,71 @@ struct pt_t {
         return newp;
     }
 };
-template <> struct std::hash<pt_t> {
-    size_t operator()(pt_t const &pt) const {
-        return static_cast<size_t>(pt.x) << 32 & pt.y;
-    }
-};
 
-enum class state : char {
-    ROCK = 0,
-    SAND = 1,
-
-};
-using grid_t = std::unordered_map<pt_t, state>;
+// rock or sand, either way it's in the way
+using grid_t = grid<bool, 2>;
 
 constexpr auto parse(std::string_view input) {
-    auto traces =
-        input | vw::split("\n"sv) |
-        vw::transform(vw::split(" -> "sv) |
-                      vw::transform(vw::split(","sv) | vw::transform(to_int)) |
-                      vw::transform([](auto &&r) {
-                          auto const [x, y] = to_array_of<2, int>(r);
-                          return pt_t{.x = x, .y = y};
-                      })) |
-        vw::transform([](auto &&r) { return to_vec<pt_t>(r); });
+    auto const batch = parse_ints(input, " ->,"sv);
+
+    auto traces = std::vector<std::vector<pt_t>>(batch.record_count());
+    for (size_t i = 0; i < traces.size(); ++i) {
+        auto const coords = batch.record(i);
+        for (size_t j = 0; j + 1 < coords.size(); j += 2) {
+            traces[i].push_back({
+                .x = static_cast<int>(coords[j]),
+                .y = static_cast<int>(coords[j + 1]),
+            });
+        }
+    }
 
     return traces;
 }
 
-using grid_t = std::unordered_map<pt_t, state>;
-
-auto lay_ground(grid_t &grid, pt_t sand) {
-
-}
-
 auto lay_sand(grid_t &grid, pt_t sand, int max_y, bool part_2 = false) -> bool {
 
     auto under = sand + pt_t{0, 1};
     auto under_left = sand + pt_t{-1, 1};
     auto under_right = sand + pt_t{1, 1};
 
-    if (sand.y > max_y) {
-        if(not part_2) {
-            return false; // done
-        }
-        
-        // lay ground
-        grid.try_emplace(under, state::ROCK);
-        grid.try_emplace(under_left, state::ROCK);
-        grid.try_emplace(under_right, state::ROCK);
+    // the floor is already in the grid for part 2
+    if (sand.y > max_y and not part_2) {
+        return false; // done
     }
 
-    if (not grid.contains(under))
+    if (not grid[{under.x, under.y}])
         return lay_sand(grid, under, max_y, part_2);
-    if (not grid.contains(under_left))
+    if (not grid[{under_left.x, under_left.y}])
         return lay_sand(grid, under_left, max_y, part_2);
-    if (not grid.contains(under_right))
+    if (not grid[{under_right.x, under_right.y}])
         return lay_sand(grid, under_right, max_y, part_2);
 
-    return grid.try_emplace(sand, state::SAND)
-        .second; // if we could "lay" the sand, return true;
+    // if we could "lay" the sand, return true;
+    return not grid.set({sand.x, sand.y});
 }
 
 constexpr auto solve(range_of<std::vector<pt_t>> auto traces)
     -> std::pair<int, int> {
-    auto grid = grid_t{};
+    auto source = pt_t{.x = 500, .y = 0};
 
-    auto grid_max_x = 0;
     auto grid_max_y = 0;
+    auto rock_min_x = source.x;
+    auto rock_max_x = source.x;
+    auto rock_min_y = source.y;
+    for (auto &&trace : traces) {
+        for (auto const pt : trace) {
+            grid_max_y = std::max(pt.y, grid_max_y);
+            rock_min_x = std::min(pt.x, rock_min_x);
+            rock_max_x = std::max(pt.x, rock_max_x);
+            rock_min_y = std::min(pt.y, rock_min_y);
+        }
+    }
+
+    // sand can't go further sideways than down, the floor is 2 below the
+    // lowest rock. Rocks out of the sand's reach still have to fit.
+    auto const floor = grid_max_y + 2;
+    auto grid = grid_t{{std::min(source.x - floor - 1, rock_min_x), rock_min_y},
+                       {std::max(source.x + floor + 1, rock_max_x), floor}};
 
     for (auto &&trace : traces) {
         for (int i = 1; i < trace.size(); ++i) {
@@ -102,26 +99,25 @@ constexpr auto solve(range_of<std::vector<pt_t>> auto traces)
             auto [min_x, max_x] = std::minmax({prev.x, next.x});
             auto [min_y, max_y] = std::minmax({prev.y, next.y});
 
-            grid_max_x = std::max({max_x, grid_max_x});
-            grid_max_y = std::max({max_y, grid_max_y});
-
             for (auto x = min_x; x <= max_x; ++x) {
                 for (auto y = min_y; y <= max_y; ++y) {
-                    grid.try_emplace(pt_t{x, y}, state::ROCK);
+                    grid.set({x, y});
                 }
             }
         }
     }
 
-    auto source = pt_t{.x = 500, .y = 0};
-    
     auto count = 0;
 
     while (lay_sand(grid, source, grid_max_y))
         ++count;
-    
+
     auto part_1 = count;
-    
+
+    for (auto x = grid.min()[0]; x <= grid.max()[0]; ++x) {
+        grid.set({x, floor});
+    }
+
     while(lay_sand(grid, source, grid_max_y, true)) 
         ++count;
     
@@ -133,20 +129,8 @@ constexpr auto solve(range_of<std::vector<pt_t>> auto traces)
 // variant isn't constexpr it seems
 // static_assert(solve(parse(example)).first == 13);
 
-int main() {
-    auto parsed = parse(example);
-    auto [p1, p2] = solve(parsed);
-    
-    println(p1);
-    println(p2);
-    
-
-    benchmark([]() {
-        auto input = fast_io::native_file_loader("input");
-
-        auto [p1, p2] = solve(parse(input));
-
-        println(p1);
-        println(p2);
-    });
+int main(int argc, char **argv) {
+    benchmark(bench::options_t::from_args(argc, argv), "day14"sv,
+              [](auto &input) { return parse(input); },
+              [](auto &traces) { return solve(traces); });
 }
\ No newline at end of file
@@ -1,11 +1,9 @@
 #include "../lib/utils.hh"
-#include <boost/container_hash/hash.hpp>
 #include <cassert>
 #include <chrono>
 #include <ctre.hpp>
 #include <numeric>
 #include <ranges>
-#include <unordered_set>
 
 constexpr auto example =
     R"(2,2,2
@@ -50,119 +48,65 @@ struct pt3d_t {
     }
 };
 
-// no diagonals, 6 possible moves
-static constexpr auto directions = {
-    pt3d_t{
-        1,
-        0,
-        0,
-    },
-    {
-        0,
-        1,
-        0,
-    },
-    {
-        0,
-        0,
-        1,
-    },
-    pt3d_t{
-        -1,
-        0,
-        0,
-    },
-    {
-        0,
-        -1,
-        0,
-    },
-    {
-        0,
-        0,
-        -1,
-    },
-};
-
-template <> struct std::hash<pt3d_t> {
-    auto operator()(pt3d_t pt) const -> size_t {
-        auto result = size_t{0};
-        boost::hash_combine(result, pt.x);
-        boost::hash_combine(result, pt.y);
-        boost::hash_combine(result, pt.z);
-        return result;
-    }
-};
-
-constexpr auto parse_one(std::string_view line) -> pt3d_t {
-    auto const [x, y, z] =
-        to_array<3>(line | vw::split(","sv) | vw::transform(to_int));
-
-    return {x, y, z};
-}
-
 constexpr auto parse(std::string_view input) -> range_of<pt3d_t> auto {
-    return input | vw::split("\n"sv) | vw::transform(parse_one);
+    auto const coords = parse_ints(input, ","sv).values;
+
+    auto points = std::vector<pt3d_t>{};
+    points.reserve(coords.size() / 3);
+    for (size_t i = 0; i + 2 < coords.size(); i += 3) {
+        points.push_back({
+            .x = static_cast<int>(coords[i]),
+            .y = static_cast<int>(coords[i + 1]),
+            .z = static_cast<int>(coords[i + 2]),
+        });
+    }
+    return points;
 }
 
-auto has_access_to_air(std::unordered_set<pt3d_t> const &points,
-                       pt3d_t const pt, pt3d_t const min, pt3d_t const max,
-                       std::unordered_set<pt3d_t> &already_visited,
-                       std::unordered_map<pt3d_t, bool> &global_cache) -> bool {
-
-    if (points.contains(pt))
-        return false;
-
-    // if it has already been visited and the answer was found, we wouldn't be
-    // here
-    if (not already_visited.emplace(pt).second)
-        return global_cache[pt] = false;
-
-    if (auto it = global_cache.find(pt); it != global_cache.end())
-        return it->second;
-
-    for (auto const dir : directions) {
-        auto const next_to = pt + dir;
-
-        // there no rock registered outside these bounds
-        if (next_to < min or max < next_to) {
-            return global_cache[next_to] = global_cache[pt] = true;
+auto exposed_sides_both(range_of<pt3d_t> auto const &points, pt3d_t const min,
+                        pt3d_t const max) -> std::pair<int, int> {
+    // one cell larger than the droplet on every side, so the air around it
+    // is one connected region, plus a padding cell: the neighbours of any
+    // cell in the box are in the storage without checking
+    auto const low = grid<bool, 3>::index_t{min.x - 1, min.y - 1, min.z - 1};
+    auto const high = grid<bool, 3>::index_t{max.x + 1, max.y + 1, max.z + 1};
+
+    // a cube listed twice is still one cube, only its first time counts
+    auto cubes = grid<bool, 3>{low, high, 1};
+    auto cells = std::vector<size_t>{};
+    for (auto const pt : points) {
+        auto const cell = cubes.offset({pt.x, pt.y, pt.z});
+        if (not cubes.set(cell)) {
+            cells.push_back(cell);
         }
+    }
 
-        if (has_access_to_air(points, next_to, min, max, already_visited,
-                              global_cache)) {
-            return global_cache[next_to] = global_cache[pt] = true;
+    // flood the air from a corner, the padding counts as visited so the
+    // flood stops at the edge of the box
+    auto outside = grid<bool, 3>{low, high, 1, false, true};
+    auto const steps = outside.neighbour_offsets();
+    auto todo = std::vector<size_t>{outside.offset(low)};
+    outside.set(todo.back());
+
+    while (not todo.empty()) {
+        auto const cell = todo.back();
+        todo.pop_back();
+
+        for (auto const step : steps) {
+            auto const next_to = cell + step;
+            if (not cubes.cell(next_to) and not outside.set(next_to)) {
+                todo.push_back(next_to);
+            }
         }
     }
 
-    return false;
-}
-
-auto exposed_sides_both(std::unordered_set<pt3d_t> const &points,
-                        pt3d_t const min, pt3d_t const max)
-    -> std::pair<int, int> {
-
     auto p1 = 0;
     auto p2 = 0;
 
-    auto global_cache = std::unordered_map<pt3d_t, bool>{};
-
-    for (auto const pt : points) {
-        for (auto const dir : directions) {
-
-            auto const next_to = pt + dir;
-
-            auto already_visited = std::unordered_set<pt3d_t>{};
-            if (has_access_to_air(points, next_to, min, max, already_visited,
-                                  global_cache)) {
-                p2 += 1;
-            }
-
-            // this means that we had to travel further than the sides,
-            // there was thus at least an air bubble
-            if (already_visited.size() > 0) {
-                p1 += 1;
-            }
+    for (auto const cell : cells) {
+        for (auto const step : steps) {
+            p1 += not cubes.cell(cell + step);
+            p2 += outside.cell(cell + step);
         }
     }
 
@@ -170,11 +114,6 @@ auto exposed_sides_both(std::unordered_set<pt3d_t> const &points,
 }
 
 auto solve(range_of<pt3d_t> auto points) -> std::pair<int, int> {
-    auto part_1 = 0;
-    auto part_2 = 0;
-
-    auto set = std::unordered_set<pt3d_t>{};
-
     auto min = pt3d_t{
         std::numeric_limits<int>::max(),
         std::numeric_limits<int>::max(),
@@ -188,8 +127,6 @@ auto solve(range_of<pt3d_t> auto points) -> std::pair<int, int> {
     };
 
     for (auto const pt : points) {
-        set.emplace(pt);
-
         min.x = std::min(pt.x, min.x);
         min.y = std::min(pt.y, min.y);
         min.z = std::min(pt.z, min.z);
@@ -199,33 +136,13 @@ auto solve(range_of<pt3d_t> auto points) -> std::pair<int, int> {
         max.z = std::max(pt.z, max.z);
     }
 
-    return exposed_sides_both(set, min, max);
+    return exposed_sides_both(points, min, max);
 }
 
-constexpr auto my_example =
-    R"(1,0,0
-0,1,0
-0,0,1
--1,0,0
-0,-1,0
-0,0,-1)"sv;
-    
-static_assert(parse_one("7,8,9") == pt3d_t{.x = 7, .y = 8, .z = 9});
-
-int main() {
-
-    auto parsed = parse(my_example);
-    auto [p1, p2] = solve(parsed);
-
-    println(p1);
-    println(p2);
-
-    benchmark([]() {
-        auto input = fast_io::native_file_loader("input");
-
-        auto [p1, p2] = solve(parse(input));
+static_assert(parse("7,8,9\n1,2,3"sv)[1] == pt3d_t{.x = 1, .y = 2, .z = 3});
 
-        println(p1);
-        println(p2);
-    });
+int main(int argc, char **argv) {
+    benchmark(bench::options_t::from_args(argc, argv), "day18"sv,
+              [](auto &input) { return parse(input); },
+              [](auto &points) { return solve(points); });
 }
\ No newline at end of file
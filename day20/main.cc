@@ -18,10 +18,17 @@ constexpr auto example =
 4)"sv;
 
 
-constexpr auto parse(std::string_view input) -> auto {
-    return input | vw::split("\n"sv) | vw::transform([i = 0](auto a) mutable {
-               return std::make_pair(i++, static_cast<int64_t>(to_int(a)));
-           });
+using pair = std::pair<int, int64_t>;
+
+constexpr auto parse(std::string_view input) -> std::vector<pair> {
+    auto const numbers = parse_ints(input, ""sv).values;
+
+    auto result = std::vector<pair>{};
+    result.reserve(numbers.size());
+    for (auto i = 0; auto const value : numbers) {
+        result.emplace_back(i++, value);
+    }
+    return result;
 }
 
 
@@ -35,8 +42,6 @@ template<std::integral Int>
     return static_cast<std::make_unsigned_t<Int>>(r >= 0 ? r : r + abs(max));
 }
 
-using pair = std::pair<int, int64_t>;
-
 auto solve(auto input) -> std::pair<long, long> {
     // pairs of their original index and the value
     auto original = to_vec<pair>(input);
@@ -100,20 +105,8 @@ constexpr auto example_2 = R"(0
 //static_assert(solve(parse(example_2)).first == -4);
 //static_assert(solve(parse(example_2)).second == -3246356612); // fails
 
-int main() {
-
-    auto parsed = parse(example);
-    auto [p1, p2] = solve(parsed);
-
-    println(p1);
-    println(p2);
-
-    benchmark([]() {
-        auto input = fast_io::native_file_loader("input");
-
-        auto [p1, p2] = solve(parse(input));
-
-        println(p1);
-        println(p2);
-    });
+int main(int argc, char **argv) {
+    benchmark(bench::options_t::from_args(argc, argv), "day20"sv,
+              [](auto &input) { return parse(input); },
+              [](auto &numbers) { return solve(numbers); });
 }
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include <malloc.h>
+
+// AOC22_ALLOC_STATS: global operator new/delete are replaced by ones that
+// count allocations, bytes and the live heap, so the benchmark can report
+// them per phase. The replacements are plain definitions, which is fine as
+// long as this only ends up in one translation unit, every day is a single
+// main.cc. Without the define everything here reads as zero.
+namespace alloc_stats {
+
+#if defined(AOC22_ALLOC_STATS)
+constexpr auto enabled = true;
+#else
+constexpr auto enabled = false;
+#endif
+
+struct values_t {
+    uint64_t allocations;
+    uint64_t bytes;
+    uint64_t peak; // live heap high-water mark, in bytes
+};
+
+namespace detail {
+inline std::atomic<uint64_t> allocations = 0;
+inline std::atomic<uint64_t> bytes = 0;
+inline std::atomic<uint64_t> live = 0;
+inline std::atomic<uint64_t> peak = 0;
+
+// what malloc really handed out, so frees take off the same amount
+inline auto allocated(void *ptr) -> void * {
+    auto const size = malloc_usable_size(ptr);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+
+    auto const now = live.fetch_add(size, std::memory_order_relaxed) + size;
+    auto high = peak.load(std::memory_order_relaxed);
+    while (now > high &&
+           !peak.compare_exchange_weak(high, now, std::memory_order_relaxed)) {
+    }
+    return ptr;
+}
+
+inline auto freeing(void *ptr) -> void {
+    if (ptr) {
+        live.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+    }
+}
+} // namespace detail
+
+// Starts a phase: the peak goes back down to what's live right now, so the
+// next read() has the high-water mark of this phase only.
+inline auto start() -> values_t {
+    detail::peak.store(detail::live.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+    return {detail::allocations.load(std::memory_order_relaxed),
+            detail::bytes.load(std::memory_order_relaxed), 0};
+}
+
+// allocations and bytes since `since`, peak since the last start()
+inline auto read(values_t since) -> values_t {
+    return {detail::allocations.load(std::memory_order_relaxed) -
+                since.allocations,
+            detail::bytes.load(std::memory_order_relaxed) - since.bytes,
+            detail::peak.load(std::memory_order_relaxed)};
+}
+
+} // namespace alloc_stats
+
+#if defined(AOC22_ALLOC_STATS)
+// the nothrow, array and sized versions all end up in these four by default
+
+auto operator new(std::size_t size) -> void * {
+    auto *ptr = std::malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc{};
+    }
+    return alloc_stats::detail::allocated(ptr);
+}
+
+auto operator new(std::size_t size, std::align_val_t align) -> void * {
+    auto const alignment = static_cast<std::size_t>(align);
+    // aligned_alloc wants a multiple of the alignment
+    auto *ptr = std::aligned_alloc(
+        alignment, ((size ? size : 1) + alignment - 1) / alignment * alignment);
+    if (!ptr) {
+        throw std::bad_alloc{};
+    }
+    return alloc_stats::detail::allocated(ptr);
+}
+
+auto operator delete(void *ptr) noexcept -> void {
+    alloc_stats::detail::freeing(ptr);
+    std::free(ptr);
+}
+
+auto operator delete(void *ptr, std::align_val_t) noexcept -> void {
+    alloc_stats::detail::freeing(ptr);
+    std::free(ptr);
+}
+#endif
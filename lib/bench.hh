@@ -0,0 +1,809 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <initializer_list>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "alloc_stats.hh"
+#include "fast_io.h"
+#include "parallel.hh"
+#include "stream.hh"
+#include "utils.hh"
+
+#if defined(AOC22_CONSTEXPR_SOLVE)
+#include "embedded_input.hh"
+#endif
+
+// stamped in by cmake/aoc22.cmake so --results can tell builds apart
+#if !defined(AOC22_COMMIT)
+#define AOC22_COMMIT "unknown"
+#endif
+#if !defined(AOC22_BUILD_FLAGS)
+#define AOC22_BUILD_FLAGS ""
+#endif
+
+namespace bench {
+
+enum class phase : int {
+    load = 0,
+    parse = 1,
+    solve = 2,
+    print = 3,
+};
+
+constexpr auto phase_names =
+    std::array{"load"sv, "parse"sv, "solve"sv, "print"sv};
+constexpr auto phase_count = phase_names.size();
+
+constexpr auto compiler =
+#if defined(__clang__)
+    "clang " __clang_version__ ""sv;
+#elif defined(__GNUC__)
+    "gcc " __VERSION__ ""sv;
+#else
+    "unknown"sv;
+#endif
+
+struct options_t {
+    int warmup = 2;
+    int runs = 10;
+    bool json = false;
+    bool counters = false;
+    char const *input = "input";
+    // --batch: solve all of these instead of `input`, answers in this order
+    std::vector<std::string> batch;
+    int threads =
+        static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    // --stream: read `input` ("-" for stdin) block by block instead of
+    // mapping it, only for the days that have a streaming solver
+    bool stream = false;
+    size_t block_size = block_reader_t::default_block_size;
+    // --results: file every phase's stats get appended to, one JSON object
+    // per line, for tools/compare
+    char const *results = nullptr;
+
+    // the day's own `--flag value`s, the ones it passed to from_args
+    std::vector<std::pair<std::string_view, std::string_view>> params;
+
+    // `day_flags` are extra `--flag value` pairs the day understands
+    static auto from_args(int argc, char const *const *argv,
+                          std::initializer_list<std::string_view> day_flags =
+                              {}) -> options_t;
+
+    auto param(std::string_view flag) const -> std::optional<std::string_view> {
+        for (auto const &[name, value] : params) {
+            if (name == flag) {
+                return value;
+            }
+        }
+        return {};
+    }
+
+    auto param(std::string_view flag, int fallback) const -> int {
+        auto const value = param(flag);
+        return value ? to_int(*value) : fallback;
+    }
+};
+
+// A directory expands to the regular files in it (sorted, so the output order
+// doesn't depend on the filesystem), `@list` to the paths listed one per line
+// in `list`, anything else is taken as a file.
+inline auto add_batch_inputs(std::vector<std::string> &into,
+                             std::string_view arg) -> void {
+    namespace fs = std::filesystem;
+
+    if (arg.starts_with('@')) {
+        auto const list = fast_io::native_file_loader(arg.substr(1));
+        for (auto const line : line_index_t::lines(std::string_view{list})) {
+            if (!line.empty()) {
+                into.emplace_back(line);
+            }
+        }
+        return;
+    }
+
+    auto const path = fs::path{arg};
+    if (!fs::is_directory(path)) {
+        into.emplace_back(arg);
+        return;
+    }
+
+    auto files = std::vector<std::string>{};
+    for (auto const &entry : fs::directory_iterator{path}) {
+        if (entry.is_regular_file()) {
+            files.push_back(entry.path().string());
+        }
+    }
+    rg::sort(files);
+    rg::move(files, std::back_inserter(into));
+}
+
+inline auto options_t::from_args(int argc, char const *const *argv,
+                                  std::initializer_list<std::string_view>
+                                      day_flags) -> options_t {
+    auto opts = options_t{};
+
+    auto const usage = [&] {
+        perr("usage: "sv, std::string_view{argv[0]},
+             " [--warmup N] [--runs N] [--json] [--counters]"sv,
+             " [--input PATH] [--batch DIR|@LIST|FILE...] [--threads N]"sv,
+             " [--stream] [--block-size BYTES] [--results FILE]"sv);
+        for (auto const flag : day_flags) {
+            perr(" ["sv, flag, " VALUE]"sv);
+        }
+        perrln(""sv);
+        std::exit(2);
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        auto const arg = std::string_view{argv[i]};
+        auto const value = [&] {
+            if (i + 1 >= argc)
+                usage();
+            return argv[++i];
+        };
+
+        if (arg == "--warmup"sv) {
+            opts.warmup = std::max(0, to_int(value()));
+        } else if (arg == "--runs"sv) {
+            opts.runs = std::max(1, to_int(value()));
+        } else if (arg == "--json"sv) {
+            opts.json = true;
+        } else if (arg == "--counters"sv) {
+            opts.counters = true;
+        } else if (arg == "--input"sv) {
+            opts.input = value();
+        } else if (arg == "--batch"sv) {
+            add_batch_inputs(opts.batch, value());
+            // everything up to the next flag is part of the batch
+            while (i + 1 < argc &&
+                   !std::string_view{argv[i + 1]}.starts_with("--"sv)) {
+                add_batch_inputs(opts.batch, argv[++i]);
+            }
+        } else if (arg == "--threads"sv) {
+            opts.threads = std::max(1, to_int(value()));
+        } else if (arg == "--stream"sv) {
+            opts.stream = true;
+        } else if (arg == "--block-size"sv) {
+            opts.block_size = std::max(1, to_int(value()));
+        } else if (arg == "--results"sv) {
+            opts.results = value();
+        } else if (rg::find(day_flags, arg) != day_flags.end()) {
+            opts.params.emplace_back(arg, value());
+        } else {
+            usage();
+        }
+    }
+
+    // --batch and the days' parallel solvers all share the one pool
+    task_pool_t::set_threads(opts.threads);
+    return opts;
+}
+
+struct stats_t {
+    size_t samples;
+    double min;
+    double median;
+    double p99;
+    double stddev;
+};
+
+// all values in microseconds
+inline auto summarize(std::vector<double> samples) -> stats_t {
+    if (samples.empty()) {
+        return {};
+    }
+
+    rg::sort(samples);
+
+    auto const n = samples.size();
+    auto const mean = std::reduce(samples.begin(), samples.end()) / n;
+    auto const squares = std::transform_reduce(
+        samples.begin(), samples.end(), 0.0, std::plus{},
+        [=](double x) { return (x - mean) * (x - mean); });
+
+    // nearest rank
+    auto const p99_rank = static_cast<size_t>(std::ceil(0.99 * n));
+
+    return {
+        .samples = n,
+        .min = samples.front(),
+        .median = n % 2 ? samples[n / 2]
+                        : (samples[n / 2 - 1] + samples[n / 2]) / 2,
+        .p99 = samples[std::max<size_t>(p99_rank, 1) - 1],
+        .stddev = n > 1 ? std::sqrt(squares / (n - 1)) : 0.0,
+    };
+}
+
+// keeps the result of a run alive without printing it
+template <typename T> inline auto do_not_optimize(T const &value) -> void {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Hardware counters through perf_event_open, opened as one group so they
+// all cover the same instructions. Events the kernel (or the VM) refuses are
+// simply missing, if even cycles can't be opened the whole thing is off.
+// They're inherited by threads started afterwards (the pool gets restarted
+// for that), kernels that won't inherit a group only count the caller.
+class counters_t {
+  public:
+    static constexpr auto names =
+        std::array{"cycles"sv, "instructions"sv, "l1d_misses"sv,
+                   "llc_misses"sv, "branch_misses"sv};
+    static constexpr auto count = names.size();
+
+    using values_t = std::array<uint64_t, count>;
+
+    counters_t() {
+#if defined(__linux__)
+        constexpr auto l1d_read_miss =
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+        using event_t = std::pair<uint32_t, uint64_t>;
+        constexpr auto events = std::array<event_t, count>{{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, l1d_read_miss},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        }};
+
+        for (size_t i = 0; i < count; ++i) {
+            auto attr = perf_event_attr{};
+            attr.size = sizeof(attr);
+            attr.type = events[i].first;
+            attr.config = events[i].second;
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.disabled = leader < 0;
+            attr.inherit = inherited;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            auto fd = static_cast<int>(
+                syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+            if (fd < 0 && leader < 0 && inherited) {
+                // the group decides, the others follow the leader
+                inherited = false;
+                attr.inherit = 0;
+                fd = static_cast<int>(
+                    syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+            }
+
+            if (fd < 0) {
+                if (leader < 0) {
+                    return; // no cycles, no counters
+                }
+                continue;
+            }
+
+            if (leader < 0) {
+                leader = fd;
+            }
+            fds[opened] = fd;
+            slots[opened++] = i;
+        }
+
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    counters_t(counters_t const &) = delete;
+    auto operator=(counters_t const &) -> counters_t & = delete;
+
+    ~counters_t() {
+#if defined(__linux__)
+        for (size_t i = 0; i < opened; ++i) {
+            close(fds[i]);
+        }
+#endif
+    }
+
+    auto available() const -> bool { return leader >= 0; }
+
+    // whether threads started since count too, or only the one that opened
+    // them
+    auto all_threads() const -> bool { return inherited; }
+
+    auto has(size_t counter) const -> bool {
+        return std::find(slots.begin(), slots.begin() + opened, counter) !=
+               slots.begin() + opened;
+    }
+
+    auto read() const -> values_t {
+        auto values = values_t{};
+#if defined(__linux__)
+        // { nr, value[nr] }
+        uint64_t buffer[1 + count]{};
+        if (leader < 0 || ::read(leader, buffer, sizeof(buffer)) <= 0) {
+            return values;
+        }
+        for (size_t i = 0; i < std::min<uint64_t>(buffer[0], opened); ++i) {
+            values[slots[i]] = buffer[1 + i];
+        }
+#endif
+        return values;
+    }
+
+  private:
+    int leader = -1;
+    bool inherited = true;
+    size_t opened = 0;
+    std::array<int, count> fds{};
+    // which of `names` each opened fd counts
+    std::array<size_t, count> slots{};
+};
+
+struct phase_samples_t {
+    std::vector<double> times; // microseconds
+    std::vector<counters_t::values_t> counters;
+    std::vector<alloc_stats::values_t> allocations;
+};
+
+// FNV-1a of the input file, results are only compared on the same input
+inline auto input_hash(char const *path) -> std::string {
+    if (std::string_view{path} == "-"sv) {
+        return "stdin";
+    }
+
+    auto const input = fast_io::native_file_loader(path);
+    auto hash = uint64_t{0xcbf29ce484222325};
+    for (auto const ch : std::string_view{input}) {
+        hash = (hash ^ static_cast<unsigned char>(ch)) * 0x100000001b3;
+    }
+
+    auto hex = std::string(16, '0');
+    for (auto i = hex.size(); i-- > 0; hash >>= 4) {
+        hex[i] = "0123456789abcdef"[hash & 0xf];
+    }
+    return hex;
+}
+
+// two decimals are plenty for microseconds
+inline auto rounded(double value) -> double {
+    return std::round(value * 100) / 100;
+}
+
+class recorder_t {
+  public:
+    // bytes of input each phase goes through, the ones that do get a GB/s
+    std::array<size_t, phase_count> input_bytes{};
+
+    explicit recorder_t(options_t const &opts) : opts{opts} {
+        if (opts.counters) {
+            counters.emplace();
+            if (!counters->available()) {
+                counters.reset();
+            } else if (counters->all_threads()) {
+                // the workers so far were started before the counters
+                task_pool_t::restart();
+            }
+        }
+    }
+
+    // runs `func` as `phase`, only keeping the samples when `record` is set
+    template <typename Func>
+    auto measure(phase p, bool record, Func &&func) -> decltype(auto) {
+        auto &into = samples[int(p)];
+
+        auto const allocations_before = alloc_stats::start();
+        auto const counters_before =
+            counters ? counters->read() : counters_t::values_t{};
+        auto const then = std::chrono::high_resolution_clock::now();
+
+        auto const done = [&] {
+            auto const now = std::chrono::high_resolution_clock::now();
+            auto const counters_after =
+                counters ? counters->read() : counters_t::values_t{};
+            auto const allocations = alloc_stats::read(allocations_before);
+
+            if (!record) {
+                return;
+            }
+
+            into.times.push_back(
+                std::chrono::duration<double, std::micro>(now - then).count());
+
+            if (counters) {
+                auto delta = counters_t::values_t{};
+                for (size_t i = 0; i < counters_t::count; ++i) {
+                    delta[i] = counters_after[i] - counters_before[i];
+                }
+                into.counters.push_back(delta);
+            }
+            if constexpr (alloc_stats::enabled) {
+                into.allocations.push_back(allocations);
+            }
+        };
+
+        if constexpr (std::is_void_v<std::invoke_result_t<Func>>) {
+            func();
+            done();
+        } else {
+            auto result = func();
+            done();
+            return result;
+        }
+    }
+
+    auto report(std::string_view name) const -> void {
+        for (size_t i = 0; i < phase_count; ++i) {
+            // streaming has no separate load/parse
+            if (samples[i].times.empty()) {
+                continue;
+            }
+            auto const s = summarize(samples[i].times);
+            // bytes per microsecond are MB/s
+            auto const throughput =
+                input_bytes[i] && s.median > 0
+                    ? std::optional{rounded(input_bytes[i] / s.median / 1000)}
+                    : std::nullopt;
+
+            if (opts.json) {
+                print("{\"day\":\""sv, name, "\",\"phase\":\""sv,
+                      phase_names[i], "\",\"runs\":"sv, s.samples,
+                      ",\"min_us\":"sv, rounded(s.min), ",\"median_us\":"sv,
+                      rounded(s.median), ",\"p99_us\":"sv, rounded(s.p99),
+                      ",\"stddev_us\":"sv, rounded(s.stddev));
+                if (throughput) {
+                    print(",\"gb_per_s\":"sv, *throughput);
+                }
+                report_counters(samples[i], ","sv, "\""sv, ":"sv);
+                report_allocations(samples[i], ","sv, "\""sv, ":"sv);
+                println("}"sv);
+            } else {
+                print(name, " "sv, phase_names[i], ": min "sv, rounded(s.min),
+                      "us median "sv, rounded(s.median), "us p99 "sv,
+                      rounded(s.p99), "us stddev "sv, rounded(s.stddev),
+                      "us ("sv, s.samples, " runs"sv);
+                if (throughput) {
+                    print(", "sv, *throughput, " GB/s"sv);
+                }
+                println(")"sv);
+                if (counters) {
+                    print(name, " "sv, phase_names[i], ":"sv);
+                    report_counters(samples[i], " "sv, ""sv, " "sv);
+                    println(""sv);
+                }
+                if (!samples[i].allocations.empty()) {
+                    print(name, " "sv, phase_names[i], ":"sv);
+                    report_allocations(samples[i], " "sv, ""sv, " "sv);
+                    println(""sv);
+                }
+            }
+        }
+
+        if (opts.results) {
+            store(name);
+        }
+    }
+
+  private:
+    // Appends one line per phase to opts.results, with every sample so
+    // tools/compare can run its test on them. A process is one run, told
+    // apart by start time and pid.
+    auto store(std::string_view name) const -> void {
+        auto const now = std::chrono::system_clock::now().time_since_epoch();
+        auto const seconds =
+            std::chrono::duration_cast<std::chrono::seconds>(now).count();
+        auto const input = input_hash(opts.input);
+
+        auto file = fast_io::obuf_file(opts.results, fast_io::open_mode::app);
+        for (size_t i = 0; i < phase_count; ++i) {
+            if (samples[i].times.empty()) {
+                continue;
+            }
+            auto const s = summarize(samples[i].times);
+
+            print(file, "{\"run\":\""sv, seconds, "-"sv, getpid(),
+                  "\",\"time\":"sv, seconds, ",\"day\":\""sv, name,
+                  "\",\"phase\":\""sv, phase_names[i], "\",\"input\":\""sv,
+                  std::string_view{input}, "\",\"compiler\":\""sv, compiler,
+                  "\",\"flags\":\""sv, std::string_view{AOC22_BUILD_FLAGS},
+                  "\",\"commit\":\""sv, std::string_view{AOC22_COMMIT},
+                  "\",\"runs\":"sv, s.samples, ",\"min_us\":"sv,
+                  rounded(s.min), ",\"median_us\":"sv, rounded(s.median),
+                  ",\"p99_us\":"sv, rounded(s.p99), ",\"stddev_us\":"sv,
+                  rounded(s.stddev), ",\"samples_us\":["sv);
+            for (size_t j = 0; j < samples[i].times.size(); ++j) {
+                print(file, j ? ","sv : ""sv, rounded(samples[i].times[j]));
+            }
+            println(file, "]}"sv);
+        }
+    }
+
+    // mean per run of every counter, plus ipc
+    auto report_counters(phase_samples_t const &phase, std::string_view sep,
+                         std::string_view quote, std::string_view assign) const
+        -> void {
+        if (!counters || phase.counters.empty()) {
+            return;
+        }
+
+        auto totals = std::array<double, counters_t::count>{};
+        for (auto const &run : phase.counters) {
+            for (size_t i = 0; i < counters_t::count; ++i) {
+                totals[i] += run[i];
+            }
+        }
+
+        auto const runs = static_cast<double>(phase.counters.size());
+        for (size_t i = 0; i < counters_t::count; ++i) {
+            if (counters->has(i)) {
+                print(sep, quote, counters_t::names[i], quote, assign,
+                      rounded(totals[i] / runs));
+            }
+        }
+        if (counters->has(0) && counters->has(1) && totals[0] > 0) {
+            print(sep, quote, "ipc"sv, quote, assign,
+                  rounded(totals[1] / totals[0]));
+        }
+        // the pool's workers ran part of it uncounted
+        if (!counters->all_threads() && opts.threads > 1) {
+            print(sep, quote, "main_thread_only"sv, quote, assign, "true"sv);
+        }
+    }
+
+    // allocations and bytes are means per run, the peak is the highest of
+    // all runs
+    auto report_allocations(phase_samples_t const &phase, std::string_view sep,
+                            std::string_view quote,
+                            std::string_view assign) const -> void {
+        if (phase.allocations.empty()) {
+            return;
+        }
+
+        auto allocations = 0.0;
+        auto bytes = 0.0;
+        auto peak = uint64_t{0};
+        for (auto const &run : phase.allocations) {
+            allocations += run.allocations;
+            bytes += run.bytes;
+            peak = std::max(peak, run.peak);
+        }
+
+        auto const runs = static_cast<double>(phase.allocations.size());
+        print(sep, quote, "allocs"sv, quote, assign,
+              rounded(allocations / runs), sep, quote, "alloc_bytes"sv, quote,
+              assign, rounded(bytes / runs), sep, quote, "peak_bytes"sv,
+              quote, assign, peak);
+    }
+
+    options_t const &opts;
+    std::array<phase_samples_t, phase_count> samples;
+    std::optional<counters_t> counters;
+};
+
+// Prints a day's answers, `between` each of them and `after` the last: the
+// two parts of a pair, or every value of a range for days that answer more
+// (day06 --windows).
+template <typename Answer>
+auto print_answer(Answer const &answer, std::string_view between = "\n"sv,
+                  std::string_view after = "\n"sv) -> void {
+    if constexpr (requires { answer.first, answer.second; }) {
+        print(answer.first, between, answer.second, after);
+    } else {
+        auto first = true;
+        for (auto const &value : answer) {
+            print(first ? ""sv : between, value);
+            first = false;
+        }
+        print(after);
+    }
+}
+
+// The answers as a run's output, one per line, or with --json one more JSON
+// object so stdout stays JSON Lines. `input` is only set for --batch.
+template <typename Answer>
+auto report_answer(options_t const &opts, std::string_view name,
+                   Answer const &answer, std::string_view input = {})
+    -> void {
+    if (!opts.json) {
+        if (!input.empty()) {
+            print(input, " "sv);
+        }
+        print_answer(answer, input.empty() ? "\n"sv : " "sv);
+        return;
+    }
+
+    print("{\"day\":\""sv, name);
+    if (!input.empty()) {
+        print("\",\"input\":\""sv, input);
+    }
+    print("\",\"answers\":["sv);
+    print_answer(answer, ","sv, "]}\n"sv);
+}
+
+// Solves every input of `opts.batch`, each worker running load -> parse ->
+// solve on its own input. A pass over the whole batch is one sample, answers
+// of the last pass are printed in batch order as `path part1 part2`.
+template <typename Parse, typename Solve>
+auto run_batch(options_t const &opts, std::string_view name, Parse &parse,
+               Solve &solve) -> void {
+    auto const &inputs = opts.batch;
+
+    using answer_t = std::decay_t<decltype(solve(
+        std::declval<std::invoke_result_t<Parse &,
+                                          fast_io::native_file_loader &> &>()))>;
+    auto answers = std::vector<std::optional<answer_t>>(inputs.size());
+
+    auto passes = std::vector<double>{};
+    auto const total = opts.warmup + opts.runs;
+
+    for (int run = 0; run < total; ++run) {
+        auto const then = std::chrono::high_resolution_clock::now();
+
+        task_pool_t::global().run(inputs.size(), [&](size_t i) {
+            auto input = fast_io::native_file_loader(inputs[i]);
+            auto parsed = parse(input);
+            answers[i].emplace(solve(parsed));
+        });
+
+        auto const now = std::chrono::high_resolution_clock::now();
+        if (run >= opts.warmup) {
+            passes.push_back(
+                std::chrono::duration<double, std::micro>(now - then).count());
+        }
+    }
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        report_answer(opts, name, *answers[i], std::string_view{inputs[i]});
+    }
+
+    auto const s = summarize(passes);
+    auto const per_second = s.median > 0 ? inputs.size() * 1e6 / s.median : 0.0;
+
+    if (opts.json) {
+        println("{\"day\":\""sv, name,
+                "\",\"phase\":\"batch\",\"inputs\":"sv, inputs.size(), ",\"threads\":"sv, opts.threads,
+                ",\"runs\":"sv, s.samples, ",\"min_us\":"sv, rounded(s.min),
+                ",\"median_us\":"sv, rounded(s.median), ",\"p99_us\":"sv,
+                rounded(s.p99), ",\"stddev_us\":"sv, rounded(s.stddev),
+                ",\"inputs_per_s\":"sv, rounded(per_second), "}"sv);
+    } else {
+        println(name, " batch: "sv, inputs.size(), " inputs on "sv,
+                opts.threads, " threads, min "sv, rounded(s.min),
+                "us median "sv, rounded(s.median), "us p99 "sv,
+                rounded(s.p99), "us ("sv, s.samples, " runs, "sv,
+                rounded(per_second), " inputs/s)"sv);
+    }
+}
+
+// Solves `opts.input` with the day's streaming solver, which gets a
+// block_reader_t and does its own reading and parsing, so it's all timed as
+// solve. stdin can only be read once, so there are no warmups nor repeats.
+template <typename Stream>
+auto run_stream(options_t const &opts, std::string_view name, Stream &stream)
+    -> void {
+    auto recorder = recorder_t{opts};
+    auto const once = std::string_view{opts.input} == "-"sv;
+    auto const total = once ? 1 : opts.warmup + opts.runs;
+
+    for (int run = 0; run < total; ++run) {
+        auto const timed = once || run >= opts.warmup;
+
+        auto const answer = recorder.measure(phase::solve, timed, [&] {
+            auto reader = block_reader_t{opts.input, opts.block_size};
+            return stream(reader);
+        });
+
+        if (run + 1 == total) {
+            recorder.measure(phase::print, timed, [&] {
+                report_answer(opts, name, answer);
+            });
+        } else {
+            do_not_optimize(answer);
+        }
+    }
+
+    recorder.report(name);
+}
+
+// For AOC22_CONSTEXPR_SOLVE builds, prints the answers the compiler worked
+// out for the embedded input. Only if that's the input asked for, otherwise
+// returns false and the day solves at runtime as usual.
+template <typename Answer>
+auto print_precomputed(options_t const &opts, std::string_view name,
+                       Answer const &answer) -> bool {
+    if (std::string_view{opts.input} != "input"sv || !opts.batch.empty() ||
+        opts.stream) {
+        return false;
+    }
+
+    auto recorder = recorder_t{opts};
+    recorder.measure(phase::print, true, [&] {
+        report_answer(opts, name, answer);
+    });
+    recorder.report(name);
+    return true;
+}
+
+} // namespace bench
+
+// Runs load -> parse -> solve `warmup + runs` times, timing every phase
+// separately. The answers are only printed (and the print phase timed) on the
+// last run, repeating it would just spam stdout.
+//
+// With --batch, parse and solve get called from several threads at once, so
+// any state they share has to be thread_local.
+template <typename Parse, typename Solve>
+auto benchmark(bench::options_t const &opts, std::string_view name,
+               Parse &&parse, Solve &&solve) -> void {
+    using bench::phase;
+
+    if (opts.stream) {
+        perrln(name, " can't --stream, it needs the whole input at once"sv);
+        std::exit(2);
+    }
+    if (!opts.batch.empty()) {
+        bench::run_batch(opts, name, parse, solve);
+        return;
+    }
+
+    auto recorder = bench::recorder_t{opts};
+    auto const total = opts.warmup + opts.runs;
+
+    for (int run = 0; run < total; ++run) {
+        auto const timed = run >= opts.warmup;
+
+        auto input = recorder.measure(phase::load, timed, [&] {
+            return fast_io::native_file_loader(opts.input);
+        });
+        auto parsed =
+            recorder.measure(phase::parse, timed, [&] { return parse(input); });
+
+        // a parse that returns a view (the input itself, or a lazy one)
+        // hasn't read anything yet, solve does
+        auto const size = std::string_view{input}.size();
+        if constexpr (!rg::view<decltype(parsed)>) {
+            recorder.input_bytes[size_t(phase::parse)] = size;
+        }
+        recorder.input_bytes[size_t(phase::solve)] = size;
+
+        auto const answer =
+            recorder.measure(phase::solve, timed, [&] { return solve(parsed); });
+
+        if (run + 1 == total) {
+            recorder.measure(phase::print, timed, [&] {
+                bench::report_answer(opts, name, answer);
+            });
+        } else {
+            bench::do_not_optimize(answer);
+        }
+    }
+
+    recorder.report(name);
+}
+
+// Same, for the days that can also solve their input as a stream, used for
+// --stream.
+template <typename Parse, typename Solve, typename Stream>
+auto benchmark(bench::options_t const &opts, std::string_view name,
+               Parse &&parse, Solve &&solve, Stream &&stream) -> void {
+    if (opts.stream) {
+        bench::run_stream(opts, name, stream);
+        return;
+    }
+    benchmark(opts, name, parse, solve);
+}
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "utils.hh"
+
+// Small work stealing pool. Every worker has its own deque: it takes its own
+// tasks from the back and, once out of work, steals from the front of the
+// others'. Whoever waits for tasks to finish runs tasks meanwhile, so tasks
+// can start more tasks without deadlocking.
+class task_pool_t {
+  public:
+    // `threads` counts the caller, so 1 means no workers at all and run()
+    // just loops
+    explicit task_pool_t(int threads) : queues(std::max(threads, 1)) {
+        for (size_t i = 1; i < queues.size(); ++i) {
+            workers.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    task_pool_t(task_pool_t const &) = delete;
+    auto operator=(task_pool_t const &) -> task_pool_t & = delete;
+
+    ~task_pool_t() {
+        {
+            auto const lock = std::lock_guard{sleep_mutex};
+            stopping = true;
+        }
+        wake.notify_all();
+        workers.clear(); // joins
+    }
+
+    auto thread_count() const -> int { return static_cast<int>(queues.size()); }
+
+    // Calls `body(i)` for every i in [0, count), returns once they're all
+    // done. The first exception a call throws is rethrown here.
+    template <typename Body> auto run(size_t count, Body &&body) -> void {
+        if (count == 0) {
+            return;
+        }
+        if (queues.size() == 1 || count == 1) {
+            for (size_t i = 0; i < count; ++i) {
+                body(i);
+            }
+            return;
+        }
+
+        auto group = std::make_shared<group_t>();
+        group->pending = count;
+        group->body = std::addressof(body);
+        group->invoke = [](void *body, size_t i) {
+            (*static_cast<std::remove_reference_t<Body> *>(body))(i);
+        };
+
+        // spread over every queue, the caller's included
+        for (size_t i = 0; i < count; ++i) {
+            auto &queue = queues[(self + i) % queues.size()];
+            auto const lock = std::lock_guard{queue.mutex};
+            queue.tasks.push_back({group, i});
+        }
+        queued += count;
+        {
+            auto const lock = std::lock_guard{sleep_mutex};
+        }
+        wake.notify_all();
+
+        // help until the group is done
+        for (auto left = group->pending.load(); left > 0;
+             left = group->pending.load()) {
+            if (auto task = take()) {
+                execute(*task);
+            } else {
+                group->pending.wait(left);
+            }
+        }
+
+        if (group->error) {
+            std::rethrow_exception(group->error);
+        }
+    }
+
+    // Shared by parallel_for/parallel_reduce, hardware_concurrency threads
+    // unless set_threads() said otherwise.
+    static auto global() -> task_pool_t & {
+        auto &pool = instance();
+        if (!pool) {
+            pool = std::make_unique<task_pool_t>(static_cast<int>(
+                std::max(1u, std::thread::hardware_concurrency())));
+        }
+        return *pool;
+    }
+
+    // replaces the global pool, not while it's in use
+    static auto set_threads(int threads) -> void {
+        auto &pool = instance();
+        if (!pool || pool->thread_count() != std::max(threads, 1)) {
+            pool.reset();
+            pool = std::make_unique<task_pool_t>(threads);
+        }
+    }
+
+    // same threads, but new workers, for what has to be set up before they
+    // start (perf counters)
+    static auto restart() -> void {
+        auto &pool = instance();
+        if (pool) {
+            auto const threads = pool->thread_count();
+            pool.reset();
+            pool = std::make_unique<task_pool_t>(threads);
+        }
+    }
+
+  private:
+    struct group_t {
+        std::atomic<size_t> pending;
+        void *body;
+        void (*invoke)(void *, size_t);
+        std::atomic<bool> failed = false;
+        std::exception_ptr error;
+    };
+
+    struct task_t {
+        // shared, the last task may still be notifying when run() returns
+        std::shared_ptr<group_t> group;
+        size_t index;
+    };
+
+    struct queue_t {
+        std::mutex mutex;
+        std::deque<task_t> tasks;
+    };
+
+    static auto instance() -> std::unique_ptr<task_pool_t> & {
+        static auto pool = std::unique_ptr<task_pool_t>{};
+        return pool;
+    }
+
+    // which queue belongs to this thread, 0 is everyone not in the pool
+    static inline thread_local size_t self = 0;
+
+    auto take() -> std::optional<task_t> {
+        if (queued.load(std::memory_order_relaxed) == 0) {
+            return {};
+        }
+
+        for (size_t i = 0; i < queues.size(); ++i) {
+            auto &queue = queues[(self + i) % queues.size()];
+            auto const lock = std::lock_guard{queue.mutex};
+            if (queue.tasks.empty()) {
+                continue;
+            }
+
+            // own work newest first, stolen work oldest first
+            auto task = std::optional<task_t>{};
+            if (i == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            --queued;
+            return task;
+        }
+        return {};
+    }
+
+    static auto execute(task_t const &task) -> void {
+        auto &group = *task.group;
+        try {
+            group.invoke(group.body, task.index);
+        } catch (...) {
+            if (!group.failed.exchange(true)) {
+                group.error = std::current_exception();
+            }
+        }
+        if (group.pending.fetch_sub(1) == 1) {
+            group.pending.notify_all();
+        }
+    }
+
+    auto work(size_t index) -> void {
+        self = index;
+        while (true) {
+            if (auto task = take()) {
+                execute(*task);
+                continue;
+            }
+
+            auto lock = std::unique_lock{sleep_mutex};
+            wake.wait(lock, [&] { return stopping || queued.load() > 0; });
+            if (stopping) {
+                return;
+            }
+        }
+    }
+
+    std::vector<queue_t> queues;
+    std::atomic<size_t> queued = 0;
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    std::vector<std::jthread> workers;
+};
+
+namespace detail {
+// how many pieces to cut `count` items in: a few per thread so stealing has
+// something to even out, none smaller than `grain`
+inline auto chunk_count(size_t count, size_t grain) -> size_t {
+    auto const threads =
+        static_cast<size_t>(task_pool_t::global().thread_count());
+    grain = std::max<size_t>(grain, 1);
+    return std::max<size_t>(std::min((count + grain - 1) / grain, threads * 4),
+                            1);
+}
+} // namespace detail
+
+// body(i) for every i in [begin, end), on the global pool
+template <typename Body>
+auto parallel_for(size_t begin, size_t end, Body &&body, size_t grain = 1)
+    -> void {
+    if (end <= begin) {
+        return;
+    }
+    auto const count = end - begin;
+    auto const chunks = detail::chunk_count(count, grain);
+
+    task_pool_t::global().run(chunks, [&](size_t chunk) {
+        auto const last = begin + count * (chunk + 1) / chunks;
+        for (auto i = begin + count * chunk / chunks; i < last; ++i) {
+            body(i);
+        }
+    });
+}
+
+// Cuts [0, count) in chunks, `map(first, last)` each of them on the pool,
+// then folds the results with `reduce`, in order, so it doesn't have to be
+// commutative.
+template <typename T, typename Map, typename Reduce>
+auto parallel_reduce(size_t count, T init, Map &&map, Reduce &&reduce,
+                     size_t grain = 1) -> T {
+    if (count == 0) {
+        return init;
+    }
+    auto const chunks = detail::chunk_count(count, grain);
+    auto partial = std::vector<std::optional<T>>(chunks);
+
+    task_pool_t::global().run(chunks, [&](size_t chunk) {
+        partial[chunk].emplace(
+            map(count * chunk / chunks, count * (chunk + 1) / chunks));
+    });
+
+    for (auto &result : partial) {
+        init = reduce(std::move(init), std::move(*result));
+    }
+    return init;
+}
+
+// Same, with one call of `map(piece)` per piece, say the chunks out of
+// split_records().
+template <typename T, typename Map, typename Reduce>
+auto parallel_reduce(std::span<std::string_view const> pieces, T init,
+                     Map &&map, Reduce &&reduce) -> T {
+    auto partial = std::vector<std::optional<T>>(pieces.size());
+
+    task_pool_t::global().run(pieces.size(), [&](size_t i) {
+        partial[i].emplace(map(pieces[i]));
+    });
+
+    for (auto &result : partial) {
+        init = reduce(std::move(init), std::move(*result));
+    }
+    return init;
+}
+
+// Cuts `input` in about `pieces` chunks (a few per thread by default) on
+// `separator`, like "\n" for lines or "\n\n" for day01's elves. The separators
+// between chunks are dropped, so every chunk parses like an input of its own.
+inline auto split_records(std::string_view input, std::string_view separator,
+                          size_t pieces = 0) -> std::vector<std::string_view> {
+    if (pieces == 0) {
+        pieces = 4 * static_cast<size_t>(task_pool_t::global().thread_count());
+    }
+
+    auto chunks = std::vector<std::string_view>{};
+    auto start = size_t{0};
+
+    // jump ahead, then on to the next separator
+    for (size_t i = 1; i < pieces && start < input.size(); ++i) {
+        auto const target = std::max(start, input.size() * i / pieces);
+        auto const end = input.find(separator, target);
+        if (end == std::string_view::npos) {
+            break;
+        }
+        if (end > start) {
+            chunks.push_back(input.substr(start, end - start));
+        }
+        start = end + separator.size();
+    }
+
+    if (start < input.size()) {
+        chunks.push_back(input.substr(start));
+    }
+    return chunks;
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <memory>
+#include <semaphore>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "utils.hh"
+
+// Reads a file (or a pipe, "-" is stdin) in fixed size blocks on a
+// background thread. There are two buffers: while the caller works on the
+// block `next()` returned, the other one is being filled. So memory stays at
+// two blocks whatever the input size, and reading overlaps with solving.
+class block_reader_t {
+  public:
+    static constexpr size_t default_block_size = 1 << 20;
+
+    explicit block_reader_t(char const *path,
+                            size_t block_size = default_block_size)
+        : block_size{std::max<size_t>(block_size, 1)} {
+        if (std::string_view{path} == "-"sv) {
+            fd = STDIN_FILENO;
+        } else {
+            fd = ::open(path, O_RDONLY);
+            if (fd < 0) {
+                throw std::system_error(errno, std::generic_category(), path);
+            }
+            owns_fd = true;
+#if defined(POSIX_FADV_SEQUENTIAL)
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        }
+
+        for (auto &buffer : buffers) {
+            buffer = std::make_unique_for_overwrite<char[]>(this->block_size);
+        }
+
+        reader = std::jthread{[this] { fill(); }};
+    }
+
+    block_reader_t(block_reader_t const &) = delete;
+    auto operator=(block_reader_t const &) -> block_reader_t & = delete;
+
+    ~block_reader_t() {
+        stop = true;
+        // wake the reader if it's waiting for a buffer to come back (one
+        // blocked in read() on a pipe still has to wait for data or EOF)
+        for (auto &semaphore : empty) {
+            semaphore.release();
+        }
+        reader.join();
+        if (owns_fd) {
+            ::close(fd);
+        }
+    }
+
+    // The next block, empty once the input is done. Only valid until the
+    // next call.
+    auto next() -> std::string_view {
+        if (done) {
+            return {};
+        }
+        if (current >= 0) {
+            empty[current].release();
+        }
+        current = (current + 1) % 2;
+        full[current].acquire();
+
+        if (errors[current]) {
+            done = true;
+            throw std::system_error(errors[current], std::generic_category(),
+                                    "read");
+        }
+        if (sizes[current] == 0) {
+            done = true;
+        }
+        return {buffers[current].get(), sizes[current]};
+    }
+
+  private:
+    auto fill() -> void {
+        for (int i = 0;; i = (i + 1) % 2) {
+            empty[i].acquire();
+            if (stop) {
+                return;
+            }
+
+            // pipes hand out whatever is there, keep going until full
+            auto size = size_t{0};
+            auto error = 0;
+            while (size < block_size) {
+                auto const got =
+                    ::read(fd, buffers[i].get() + size, block_size - size);
+                if (got < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (got <= 0) {
+                    error = got < 0 ? errno : 0;
+                    break;
+                }
+                size += got;
+            }
+
+            sizes[i] = size;
+            errors[i] = error;
+            full[i].release();
+
+            if (size == 0) {
+                return;
+            }
+        }
+    }
+
+    int fd = -1;
+    bool owns_fd = false;
+    size_t block_size;
+
+    std::array<std::unique_ptr<char[]>, 2> buffers;
+    std::array<size_t, 2> sizes{};
+    std::array<int, 2> errors{};
+    // not binary, the destructor may release one that's already up
+    using semaphore_t = std::counting_semaphore<2>;
+    std::array<semaphore_t, 2> empty{semaphore_t{1}, semaphore_t{1}};
+    std::array<semaphore_t, 2> full{semaphore_t{0}, semaphore_t{0}};
+    std::atomic<bool> stop = false;
+
+    // consumer side
+    int current = -1;
+    bool done = false;
+
+    std::jthread reader;
+};
+
+namespace detail {
+// If `separator` starts in the last bytes of `carry` and ends in `block`,
+// how far into `block` it ends.
+constexpr auto straddling(std::string_view carry, std::string_view block,
+                          std::string_view separator) -> size_t {
+    for (size_t in_carry = std::min(separator.size() - 1, carry.size());
+         in_carry > 0; --in_carry) {
+        auto const rest = separator.size() - in_carry;
+        if (carry.ends_with(separator.substr(0, in_carry)) &&
+            block.starts_with(separator.substr(in_carry, rest))) {
+            return rest;
+        }
+    }
+    return std::string_view::npos;
+}
+
+static_assert(straddling("a\n", "\nb", "\n\n") == 1);
+static_assert(straddling("a\r", "\nb", "\r\n") == 1);
+static_assert(straddling("xab", "cy", "abc") == 1);
+static_assert(straddling("xa", "bcy", "abc") == 2);
+static_assert(straddling("a\n", "b\n", "\n\n") == std::string_view::npos);
+static_assert(straddling("", "\n\nb", "\n\n") == std::string_view::npos);
+// one byte separators are never split
+static_assert(straddling("a\n", "b", "\n") == std::string_view::npos);
+} // namespace detail
+
+// Feeds `on_chunk` pieces of the input that each hold a whole number of
+// records, `group` separator-terminated records at a time (day03 needs lines
+// three by three), with the last separator cut off. So every chunk looks like
+// a small input file of its own and can go through the day's usual parse.
+// Most chunks point straight into the reader's block, only the record that
+// straddles two blocks gets copied.
+auto stream_records(block_reader_t &reader, std::string_view separator,
+                    size_t group,
+                    std::invocable<std::string_view> auto &&on_chunk) -> void {
+    auto carry = std::string{};
+    // separators already in `carry`, and where the last of them ends: a
+    // separator straddling into the next block can only start after it
+    auto pending = size_t{0};
+    auto counted = size_t{0};
+
+    for (auto block = reader.next(); !block.empty(); block = reader.next()) {
+        auto start = size_t{0};
+
+        // finish the group that started in an earlier block
+        if (!carry.empty()) {
+            auto const uncounted = std::string_view{carry}.substr(counted);
+            auto end = detail::straddling(uncounted, block, separator);
+            if (end != std::string_view::npos) {
+                ++pending;
+            } else {
+                end = 0;
+            }
+            while (pending < group) {
+                auto const found = block.find(separator, end);
+                if (found == std::string_view::npos) {
+                    break;
+                }
+                end = found + separator.size();
+                ++pending;
+            }
+
+            if (pending < group) {
+                if (end > 0) {
+                    counted = carry.size() + end;
+                }
+                carry.append(block);
+                continue;
+            }
+
+            carry.append(block.substr(0, end));
+            on_chunk(std::string_view{carry}.substr(
+                0, carry.size() - separator.size()));
+            carry.clear();
+            pending = 0;
+            start = end;
+        }
+
+        // the rest goes as one chunk, up to the last complete group
+        auto cut = start;
+        auto last = start;
+        for (auto pos = block.find(separator, start);
+             pos != std::string_view::npos;
+             pos = block.find(separator, pos + separator.size())) {
+            last = pos + separator.size();
+            if (++pending == group) {
+                cut = last;
+                pending = 0;
+            }
+        }
+
+        if (cut > start) {
+            on_chunk(block.substr(start, cut - start - separator.size()));
+        }
+        carry.assign(block.substr(cut));
+        counted = last - cut;
+    }
+
+    if (!carry.empty()) {
+        auto const last = std::string_view{carry};
+        on_chunk(last.ends_with(separator)
+                     ? last.substr(0, last.size() - separator.size())
+                     : last);
+    }
+}
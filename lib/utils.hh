@@ -2,16 +2,27 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <cassert>
 #include <charconv>
 #include <chrono>
 #include <concepts>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <memory_resource>
 #include <numeric>
 #include <ranges>
+#include <span>
 #include <string_view>
 #include <vector>
 
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 #include "fast_io.h"
 
 using int128_t = __int128;
@@ -124,25 +135,922 @@ template <typename DestType> constexpr auto to_vec(rg::range auto &&range) {
     return to_int_impl(input);
 }
 
+// 8 ascii digits, most significant first, to their value
+[[gnu::always_inline]] inline auto swar_parse_8(uint64_t chunk) -> uint64_t {
+    chunk -= 0x3030303030303030;
+    chunk = chunk * 10 + (chunk >> 8);
+    chunk = ((chunk & 0x000000FF000000FF) * (100 + (1000000ull << 32)) +
+             ((chunk >> 16) & 0x000000FF000000FF) * (1 + (10000ull << 32))) >>
+            32;
+    return chunk;
+}
+
+// `len` ascii digits (at most 19) to their value, never reads past `len`
+inline auto parse_digits(char const *it, size_t len) -> uint64_t {
+    auto value = uint64_t{0};
+
+    for (; len > 8; it += 8, len -= 8) {
+        auto chunk = uint64_t{};
+        std::memcpy(&chunk, it, 8);
+        value = value * 100'000'000 + swar_parse_8(chunk);
+    }
+
+    constexpr auto pow10 = std::array<uint64_t, 9>{
+        1, 10, 100, 1'000, 10'000, 100'000, 1'000'000, 10'000'000, 100'000'000};
+
+    // left pad with zeroes
+    auto chunk = uint64_t{0x3030303030303030};
+    std::memcpy(reinterpret_cast<char *>(&chunk) + 8 - len, it, len);
+
+    return value * pow10[len] + swar_parse_8(chunk);
+}
+
+// same, but for 1 to 8 digits with at least 8 readable bytes ending at
+// `it + len`, avoids the variable length copy
+inline auto parse_digits_unpadded(char const *it, size_t len) -> uint64_t {
+    auto chunk = uint64_t{};
+    std::memcpy(&chunk, it + len - 8, 8);
+
+    // the digits are the top `len` bytes, replace the rest with '0'
+    auto const keep = ~uint64_t{0} << (8 * (8 - len));
+    return swar_parse_8((chunk & keep) | (0x3030303030303030 & ~keep));
+}
+
+namespace detail {
+
+struct int_masks_t {
+    uint64_t digits;
+    uint64_t records;
+    uint64_t known; // digits and delimiters, signs are up to the caller
+};
+
+// classifies the 64 bytes at `it`, which must all be readable
+inline auto classify_64(char const *it, std::string_view delimiters,
+                        char record_delimiter) -> int_masks_t {
+#if defined(__AVX2__)
+    constexpr auto lanes = 32;
+    auto const zero = _mm256_set1_epi8('0');
+    auto const nine = _mm256_set1_epi8(9);
+    auto const records = _mm256_set1_epi8(record_delimiter);
+
+    auto const classify = [&](char const *at) {
+        auto const v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(at));
+        auto const offset = _mm256_sub_epi8(v, zero);
+        auto const digit =
+            _mm256_cmpeq_epi8(_mm256_min_epu8(offset, nine), offset);
+        auto const record = _mm256_cmpeq_epi8(v, records);
+
+        auto known = _mm256_or_si256(digit, record);
+        for (auto const delimiter : delimiters) {
+            known = _mm256_or_si256(
+                known, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(delimiter)));
+        }
+
+        return int_masks_t{
+            .digits = uint32_t(_mm256_movemask_epi8(digit)),
+            .records = uint32_t(_mm256_movemask_epi8(record)),
+            .known = uint32_t(_mm256_movemask_epi8(known)),
+        };
+    };
+#elif defined(__SSE2__)
+    constexpr auto lanes = 16;
+    auto const zero = _mm_set1_epi8('0');
+    auto const nine = _mm_set1_epi8(9);
+    auto const records = _mm_set1_epi8(record_delimiter);
+
+    auto const classify = [&](char const *at) {
+        auto const v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(at));
+        auto const offset = _mm_sub_epi8(v, zero);
+        auto const digit = _mm_cmpeq_epi8(_mm_min_epu8(offset, nine), offset);
+        auto const record = _mm_cmpeq_epi8(v, records);
+
+        auto known = _mm_or_si128(digit, record);
+        for (auto const delimiter : delimiters) {
+            known = _mm_or_si128(known,
+                                 _mm_cmpeq_epi8(v, _mm_set1_epi8(delimiter)));
+        }
+
+        return int_masks_t{
+            .digits = uint16_t(_mm_movemask_epi8(digit)),
+            .records = uint16_t(_mm_movemask_epi8(record)),
+            .known = uint16_t(_mm_movemask_epi8(known)),
+        };
+    };
+#else
+    constexpr auto lanes = 64;
+    auto const classify = [&](char const *at) {
+        auto masks = int_masks_t{};
+        for (int i = 0; i < lanes; ++i) {
+            auto const c = at[i];
+            auto const bit = uint64_t{1} << i;
+            auto const digit = c >= '0' && c <= '9';
+            masks.digits |= digit ? bit : 0;
+            masks.records |= c == record_delimiter ? bit : 0;
+            masks.known |=
+                digit || c == record_delimiter || delimiters.contains(c) ? bit
+                                                                         : 0;
+        }
+        return masks;
+    };
+#endif
+
+    auto masks = int_masks_t{};
+    for (int i = 0; i < 64; i += lanes) {
+        auto const part = classify(it + i);
+        masks.digits |= part.digits << i;
+        masks.records |= part.records << i;
+        masks.known |= part.known << i;
+    }
+    return masks;
+}
+
+// bit i is set when it[i] == needle, the 64 bytes at `it` must be readable
+inline auto match_64(char const *it, char needle) -> uint64_t {
+#if defined(__AVX2__)
+    auto const n = _mm256_set1_epi8(needle);
+    auto const lo = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(it));
+    auto const hi =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(it + 32));
+    return uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, n)))) |
+           uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, n))))
+               << 32;
+#elif defined(__SSE2__)
+    auto const n = _mm_set1_epi8(needle);
+    auto mask = uint64_t{0};
+    for (int i = 0; i < 64; i += 16) {
+        auto const v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(it + i));
+        mask |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, n))))
+                << i;
+    }
+    return mask;
+#else
+    auto mask = uint64_t{0};
+    for (int i = 0; i < 64; ++i) {
+        mask |= uint64_t{it[i] == needle} << i;
+    }
+    return mask;
+#endif
+}
+
+// same, for the `size` (< 64) bytes left at the end of a buffer
+inline auto match_tail(char const *it, size_t size, char needle) -> uint64_t {
+    char padded[64]{};
+    std::memcpy(padded, it, size);
+    return match_64(padded, needle) & ((uint64_t{1} << size) - 1);
+}
+
+} // namespace detail
+
+struct int_batch_result_t {
+    size_t count;    // values produced
+    char const *end; // where parsing stopped, like std::from_chars
+    bool ok;         // false on an unexpected byte or when told to stop
+};
+
+// Calls `on_value` for every signed decimal integer in `input`, stopping
+// early if it returns false. Numbers may be separated by any of `delimiters`,
+// `record_delimiter` additionally calls `on_record` (an empty record is just
+// two calls in a row, same as vw::split yielding an empty line). A '-' or '+'
+// directly before a digit, and not after one, is a sign: "2-4" is two numbers
+// while "-> -4" is a negative one.
+constexpr auto parse_ints_with(std::string_view input,
+                               std::string_view delimiters,
+                               char record_delimiter,
+                               std::predicate<int64_t> auto &&on_value,
+                               std::invocable auto &&on_record)
+    -> int_batch_result_t {
+
+    auto count = size_t{0};
+
+    constexpr auto is_digit = [](char c) { return c >= '0' && c <= '9'; };
+
+    if (std::is_constant_evaluated()) {
+        auto const begin = input.begin();
+        auto it = begin;
+        while (it != input.end()) {
+            auto const c = *it;
+            auto const is_sign = (c == '-' || c == '+') &&
+                                 it + 1 != input.end() && is_digit(it[1]) &&
+                                 (it == begin || !is_digit(it[-1]));
+
+            if (is_digit(c) || is_sign) {
+                auto const start = it;
+                if (is_sign) {
+                    ++it;
+                }
+                auto value = int64_t{0};
+                for (; it != input.end() && is_digit(*it); ++it) {
+                    value = value * 10 + (*it - '0');
+                }
+                if (!on_value(c == '-' ? -value : value)) {
+                    return {count, input.data() + (start - begin), false};
+                }
+                ++count;
+                continue;
+            }
+
+            if (c == record_delimiter) {
+                on_record();
+            } else if (!delimiters.contains(c)) {
+                return {count, input.data() + (it - begin), false};
+            }
+            ++it;
+        }
+        return {count, input.data() + input.size(), true};
+    }
+
+    auto const *const data = input.data();
+    auto const size = input.size();
+
+    auto const masks_at = [&](size_t base) {
+        if (size - base >= 64) {
+            return detail::classify_64(data + base, delimiters,
+                                       record_delimiter);
+        }
+
+        char padded[64]{};
+        std::memcpy(padded, data + base, size - base);
+        auto masks = detail::classify_64(padded, delimiters, record_delimiter);
+
+        auto const valid = (uint64_t{1} << (size - base)) - 1;
+        masks.digits &= valid;
+        masks.records &= valid;
+        masks.known |= ~valid;
+        return masks;
+    };
+
+    // `base` is where the current 64 byte window starts, `pos` the cursor
+    auto base = size_t{0};
+    auto pos = size_t{0};
+    auto masks = size ? masks_at(0) : detail::int_masks_t{};
+
+    // a '-' or '+' at `i` that belongs to the number after it
+    auto const is_sign_at = [&](size_t i) {
+        return (data[i] == '-' || data[i] == '+') && i + 1 < size &&
+               is_digit(data[i + 1]) && (i == 0 || !is_digit(data[i - 1]));
+    };
+
+    // handles the separators under `live`, false if one is unknown
+    auto const consume_gap = [&](uint64_t live) -> bool {
+        auto unknown = ~masks.known & live;
+        // signs are rare, look at them one by one
+        while (unknown && is_sign_at(base + std::countr_zero(unknown))) {
+            unknown &= unknown - 1;
+        }
+        if (unknown) {
+            auto const before = (uint64_t{1} << std::countr_zero(unknown)) - 1;
+            for (auto n = std::popcount(masks.records & live & before); n;
+                 --n) {
+                on_record();
+            }
+            pos = base + std::countr_zero(unknown);
+            return false;
+        }
+        for (auto n = std::popcount(masks.records & live); n; --n) {
+            on_record();
+        }
+        return true;
+    };
+
+    while (base < size) {
+        auto const live = ~uint64_t{0} << (pos - base);
+        auto const digits = masks.digits & live;
+
+        if (!digits) {
+            if (!consume_gap(live)) {
+                return {count, data + pos, false};
+            }
+            base += 64;
+            pos = base;
+            if (base < size) {
+                masks = masks_at(base);
+            }
+            continue;
+        }
+
+        auto const offset = std::countr_zero(digits);
+        if (!consume_gap(live & ((uint64_t{1} << offset) - 1))) {
+            return {count, data + pos, false};
+        }
+
+        auto const start = base + offset;
+        auto end = start + std::countr_one(masks.digits >> offset);
+        if (end - base == 64) {
+            while (end < size && is_digit(data[end])) {
+                ++end;
+            }
+        }
+
+        // branchless, the sign is a coin flip on most inputs
+        auto const before = start > 0 ? data[start - 1] : ' ';
+        auto const before_that = start > 1 ? data[start - 2] : ' ';
+        auto const signed_ =
+            (before == '-' || before == '+') & !is_digit(before_that);
+        auto const negative = signed_ & (before == '-');
+
+        auto const len = end - start;
+        auto const value = static_cast<int64_t>(
+            len <= 8 && end >= 8 ? parse_digits_unpadded(data + start, len)
+                                 : parse_digits(data + start, len));
+        if (!on_value(negative ? -value : value)) {
+            return {count, data + start - signed_, false};
+        }
+        ++count;
+
+        pos = end;
+        if (pos - base >= 64) {
+            base = pos;
+            if (base < size) {
+                masks = masks_at(base);
+            }
+        }
+    }
+
+    return {count, data + size, true};
+}
+
+// Into a caller provided buffer, stops once `out` is full.
+constexpr auto parse_ints(std::string_view input, std::span<int64_t> out,
+                          std::string_view delimiters,
+                          char record_delimiter = '\n',
+                          std::vector<size_t> *record_starts = nullptr)
+    -> int_batch_result_t {
+    auto count = size_t{0};
+
+    if (record_starts) {
+        record_starts->push_back(0);
+    }
+
+    return parse_ints_with(
+        input, delimiters, record_delimiter,
+        [&](int64_t value) {
+            if (count == out.size()) {
+                return false;
+            }
+            out[count++] = value;
+            return true;
+        },
+        [&] {
+            if (record_starts) {
+                record_starts->push_back(count);
+            }
+        });
+}
+
+struct int_batch_t {
+    std::vector<int64_t> values;
+    // index of the first value of each record
+    std::vector<size_t> record_starts;
+    char const *end;
+    bool ok;
+
+    constexpr auto record_count() const -> size_t {
+        return record_starts.size();
+    }
+
+    constexpr auto record(size_t i) const -> std::span<int64_t const> {
+        auto const last = i + 1 < record_starts.size() ? record_starts[i + 1]
+                                                       : values.size();
+        return std::span{values}.subspan(record_starts[i],
+                                         last - record_starts[i]);
+    }
+};
+
+constexpr auto parse_ints(std::string_view input, std::string_view delimiters,
+                          char record_delimiter = '\n') -> int_batch_t {
+    auto batch = int_batch_t{};
+    batch.record_starts.push_back(0);
+
+    auto const [count, end, ok] = parse_ints_with(
+        input, delimiters, record_delimiter,
+        [&](int64_t value) {
+            batch.values.push_back(value);
+            return true;
+        },
+        [&] { batch.record_starts.push_back(batch.values.size()); });
+
+    batch.end = end;
+    batch.ok = ok;
+    return batch;
+}
+
+namespace detail {
+// Both paths have to read this the same way: a sign only right before a
+// digit and not after one, otherwise '-' has to be a delimiter, and values
+// past int. The -12 starts at byte 63, so the runtime path sees its sign
+// and its digits in two different windows.
+constexpr auto parse_ints_sample = "498,4 -> -498,+6 -> 2-3,-9000000000\n"
+                                   "7 ->                       -12,+34\n"
+                                   "-5"sv;
+constexpr auto parse_ints_sample_values = std::array<int64_t, 11>{
+    498, 4, -498, 6, 2, 3, -9'000'000'000, 7, -12, 34, -5};
+
+// checked at compile time below, and at runtime in debug builds
+constexpr auto parse_ints_agree() -> bool {
+    auto const batch = parse_ints(parse_ints_sample, " ->,"sv);
+    return batch.ok && batch.record_count() == 3 &&
+           rg::equal(batch.values, parse_ints_sample_values);
+}
+} // namespace detail
+
+static_assert(detail::parse_ints_agree());
+
+#if !defined(NDEBUG)
+// the SIMD path can't be static_asserted, debug builds check it once at
+// startup, whichever binary they are
+inline auto const parse_ints_checked = [] {
+    assert(detail::parse_ints_agree());
+    return true;
+}();
+#endif
+
 template <typename Range, typename Value>
 concept range_of =
     rg::range<Range> && std::is_convertible_v<rg::range_value_t<Range>, Value>;
 
+// Zero copy index over the lines of a buffer, or over its blank line
+// separated groups. Yields exactly what `input | vw::split("\n"sv)` (or
+// "\n\n"sv) would, as std::string_view, but with random access and a size.
+// Meant to be built once over a mapped file and kept alongside it.
+class line_index_t {
+  public:
+    class iterator {
+      public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::string_view;
 
-// helpful with std::visit
-template <class... Ts> struct overloaded : Ts... {
-    using Ts::operator()...;
+        constexpr iterator() = default;
+        constexpr iterator(line_index_t const *index, difference_type i)
+            : index{index}, i{i} {}
+
+        constexpr auto operator*() const -> std::string_view {
+            return (*index)[i];
+        }
+        constexpr auto operator[](difference_type n) const -> std::string_view {
+            return (*index)[i + n];
+        }
+
+        constexpr auto operator++() -> iterator & { return ++i, *this; }
+        constexpr auto operator--() -> iterator & { return --i, *this; }
+        constexpr auto operator++(int) -> iterator { return {index, i++}; }
+        constexpr auto operator--(int) -> iterator { return {index, i--}; }
+        constexpr auto operator+=(difference_type n) -> iterator & {
+            return i += n, *this;
+        }
+        constexpr auto operator-=(difference_type n) -> iterator & {
+            return i -= n, *this;
+        }
+
+        constexpr friend auto operator+(iterator it, difference_type n)
+            -> iterator {
+            return it += n;
+        }
+        constexpr friend auto operator+(difference_type n, iterator it)
+            -> iterator {
+            return it += n;
+        }
+        constexpr friend auto operator-(iterator it, difference_type n)
+            -> iterator {
+            return it -= n;
+        }
+        constexpr friend auto operator-(iterator a, iterator b)
+            -> difference_type {
+            return a.i - b.i;
+        }
+
+        constexpr auto operator==(iterator const &other) const -> bool {
+            return i == other.i;
+        }
+        constexpr auto operator<=>(iterator const &other) const {
+            return i <=> other.i;
+        }
+
+      private:
+        line_index_t const *index = nullptr;
+        difference_type i = 0;
+    };
+
+    constexpr static auto lines(std::string_view input) -> line_index_t {
+        return line_index_t{input, false};
+    }
+
+    constexpr static auto groups(std::string_view input) -> line_index_t {
+        return line_index_t{input, true};
+    }
+
+    constexpr auto operator[](size_t i) const -> std::string_view {
+        return input.substr(starts[i], starts[i + 1] - starts[i] - separator);
+    }
+
+    constexpr auto size() const -> size_t { return starts.size() - 1; }
+    constexpr auto empty() const -> bool { return size() == 0; }
+    constexpr auto front() const -> std::string_view { return (*this)[0]; }
+    constexpr auto back() const -> std::string_view {
+        return (*this)[size() - 1];
+    }
+
+    constexpr auto begin() const -> iterator { return {this, 0}; }
+    constexpr auto end() const -> iterator {
+        return {this, static_cast<std::ptrdiff_t>(size())};
+    }
+
+  private:
+    constexpr line_index_t(std::string_view input, bool blank_lines)
+        : input{input}, separator{blank_lines ? size_t{2} : size_t{1}} {
+
+        starts.push_back(0);
+
+        // vw::split yields nothing at all for an empty input
+        if (input.empty()) {
+            return;
+        }
+
+        if (std::is_constant_evaluated()) {
+            auto const needle = blank_lines ? "\n\n"sv : "\n"sv;
+            for (auto pos = input.find(needle); pos != input.npos;
+                 pos = input.find(needle, pos + separator)) {
+                starts.push_back(pos + separator);
+            }
+        } else if (blank_lines) {
+            index_groups();
+        } else {
+            index_lines();
+        }
+
+        // so that the last element ends at input.size()
+        starts.push_back(input.size() + separator);
+    }
+
+    auto newlines_at(size_t base) const -> uint64_t {
+        return input.size() - base >= 64
+                   ? detail::match_64(input.data() + base, '\n')
+                   : detail::match_tail(input.data() + base,
+                                        input.size() - base, '\n');
+    }
+
+    auto index_lines() -> void {
+        starts.reserve(input.size() / 32);
+
+        for (size_t base = 0; base < input.size(); base += 64) {
+            for (auto mask = newlines_at(base); mask; mask &= mask - 1) {
+                starts.push_back(base + std::countr_zero(mask) + 1);
+            }
+        }
+    }
+
+    auto index_groups() -> void {
+        // a "\n\n" may straddle two blocks, hence the lookahead
+        auto next = input.empty() ? 0 : newlines_at(0);
+        auto resume = size_t{0}; // separators can't overlap
+
+        for (size_t base = 0; base < input.size(); base += 64) {
+            auto const current = next;
+            next = base + 64 < input.size() ? newlines_at(base + 64) : 0;
+
+            auto pairs = current & ((current >> 1) | (next << 63));
+            for (; pairs; pairs &= pairs - 1) {
+                auto const pos = base + std::countr_zero(pairs);
+                if (pos >= resume) {
+                    starts.push_back(pos + 2);
+                    resume = pos + 2;
+                }
+            }
+        }
+    }
+
+    std::string_view input;
+    size_t separator;
+    // offset of each element, plus one past the end of the last one
+    std::vector<size_t> starts;
 };
-template <class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
 
-auto benchmark(auto&& func) {
 
-    auto then = std::chrono::high_resolution_clock::now();
+// Allocator for node based structures that should come out of an arena_t.
+// Without a resource, or during constant evaluation, it is std::allocator,
+// so the same types keep working in the constexpr solvers.
+template <typename T> struct arena_allocator {
+    using value_type = T;
+
+    std::pmr::memory_resource *resource = nullptr;
+
+    constexpr arena_allocator() = default;
+    constexpr arena_allocator(std::pmr::memory_resource *resource)
+        : resource{resource} {}
+    template <typename U>
+    constexpr arena_allocator(arena_allocator<U> const &other)
+        : resource{other.resource} {}
+
+    [[nodiscard]] constexpr auto allocate(size_t n) -> T * {
+        if (std::is_constant_evaluated() || !resource) {
+            return std::allocator<T>{}.allocate(n);
+        }
+        return static_cast<T *>(resource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    constexpr auto deallocate(T *ptr, size_t n) -> void {
+        if (std::is_constant_evaluated() || !resource) {
+            std::allocator<T>{}.deallocate(ptr, n);
+            return;
+        }
+        resource->deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+
+    template <typename U>
+    constexpr auto operator==(arena_allocator<U> const &other) const -> bool {
+        return resource == other.resource;
+    }
+};
+
+// Monotonic arena: allocations are a pointer bump into a few large slabs,
+// freeing is a no-op and release() drops everything at once. Not thread safe.
+class arena_t {
+  public:
+    explicit arena_t(size_t initial_size = 64 * 1024)
+        : upstream{initial_size} {}
+
+    arena_t(arena_t const &) = delete;
+    auto operator=(arena_t const &) -> arena_t & = delete;
+
+    auto resource() -> std::pmr::memory_resource * { return &upstream; }
+
+    template <typename T> auto allocator() -> arena_allocator<T> {
+        return {&upstream};
+    }
+
+    auto release() -> void { upstream.release(); }
+
+  private:
+    std::pmr::monotonic_buffer_resource upstream;
+};
+
+namespace detail {
+// Shape shared by grid<T, Dims> and its packed bool version: where the
+// origin is, how far each axis goes and how to get from coordinates to an
+// offset into the storage. Coordinates are {x, y, ...}, x varies fastest, so
+// a 2D grid is stored row by row.
+template <size_t Dims> class grid_shape_t {
+  public:
+    using index_t = std::array<int, Dims>;
+
+    static constexpr auto neighbour_count = 2 * Dims;
+
+    constexpr grid_shape_t() = default;
+
+    // cells from `min` to `max`, both included, with `padding` more cells on
+    // each side of every axis
+    constexpr grid_shape_t(index_t min, index_t max, int padding)
+        : padding{padding} {
+        auto stride = size_t{1};
+        for (size_t d = 0; d < Dims; ++d) {
+            origin[d] = min[d] - padding;
+            extents[d] = static_cast<size_t>(max[d] - min[d] + 1 + 2 * padding);
+            strides[d] = stride;
+            stride *= extents[d];
+        }
+        cells = stride;
+    }
+
+    constexpr auto size() const -> size_t { return cells; }
+    constexpr auto extent(size_t d) const -> size_t { return extents[d]; }
+
+    // first and last cell, padding not included
+    constexpr auto min() const -> index_t {
+        auto result = origin;
+        for (auto &x : result) {
+            x += padding;
+        }
+        return result;
+    }
+    constexpr auto max() const -> index_t {
+        auto result = index_t{};
+        for (size_t d = 0; d < Dims; ++d) {
+            result[d] = origin[d] + static_cast<int>(extents[d]) - 1 - padding;
+        }
+        return result;
+    }
+
+    // anywhere in the storage, padding included
+    constexpr auto contains(index_t pt) const -> bool {
+        for (size_t d = 0; d < Dims; ++d) {
+            if (pt[d] < origin[d] ||
+                pt[d] >= origin[d] + static_cast<int>(extents[d])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr auto offset(index_t pt) const -> size_t {
+        auto result = size_t{0};
+        for (size_t d = 0; d < Dims; ++d) {
+            result += static_cast<size_t>(pt[d] - origin[d]) * strides[d];
+        }
+        return result;
+    }
+
+    constexpr auto index(size_t offset) const -> index_t {
+        auto result = index_t{};
+        for (size_t d = Dims; d-- > 0;) {
+            result[d] = origin[d] + static_cast<int>(offset / strides[d]);
+            offset %= strides[d];
+        }
+        return result;
+    }
+
+    // what to add to an offset to step once along each axis, -x, +x, -y, ...
+    // With a padding of 1 these never leave the storage from a non padding
+    // cell, so neighbour loops don't need any bounds check.
+    constexpr auto neighbour_offsets() const
+        -> std::array<ptrdiff_t, neighbour_count> {
+        auto result = std::array<ptrdiff_t, neighbour_count>{};
+        for (size_t d = 0; d < Dims; ++d) {
+            result[2 * d] = -static_cast<ptrdiff_t>(strides[d]);
+            result[2 * d + 1] = static_cast<ptrdiff_t>(strides[d]);
+        }
+        return result;
+    }
+
+    constexpr auto neighbours(index_t pt) const
+        -> std::array<index_t, neighbour_count> {
+        auto result = std::array<index_t, neighbour_count>{};
+        for (size_t d = 0; d < Dims; ++d) {
+            result[2 * d] = result[2 * d + 1] = pt;
+            --result[2 * d][d];
+            ++result[2 * d + 1][d];
+        }
+        return result;
+    }
+
+    // calls `func(offset)` for every padding cell
+    constexpr auto for_each_padding(std::invocable<size_t> auto &&func) const
+        -> void {
+        if (padding <= 0 || cells == 0) {
+            return;
+        }
+
+        // row by row (along x), a row is either padding all the way or only
+        // at both ends. `at` walks the other axes like an odometer, so there
+        // is no going from offsets back to coordinates.
+        auto const pad = static_cast<size_t>(padding);
+        auto const width = extents[0];
+        auto at = std::array<size_t, Dims>{};
+
+        for (size_t row = 0; row < cells; row += width) {
+            auto whole = false;
+            for (size_t d = 1; d < Dims; ++d) {
+                whole |= at[d] < pad || at[d] >= extents[d] - pad;
+            }
 
-    func();
+            for (size_t x = 0; x < width; ++x) {
+                if (whole || x < pad || x >= width - pad) {
+                    func(row + x);
+                } else {
+                    x = width - pad - 1;
+                }
+            }
 
-    auto now = std::chrono::high_resolution_clock::now();
-    auto diff = std::chrono::duration<double, std::micro>(now - then);
+            for (size_t d = 1; d < Dims && ++at[d] == extents[d]; ++d) {
+                at[d] = 0;
+            }
+        }
+    }
+
+  protected:
+    index_t origin{};
+    std::array<size_t, Dims> extents{};
+    std::array<size_t, Dims> strides{};
+    size_t cells = 0;
+    int padding = 0;
+};
+} // namespace detail
+
+// Dense Dims dimensional grid for when the cells are known to sit in some
+// box, instead of hashing coordinates into an unordered_map. The padding
+// cells get `border`, which usually is something the neighbour loop stops on
+// (a wall, "already visited"), so it doesn't need bounds checks.
+template <typename T, size_t Dims> class grid : public detail::grid_shape_t<Dims> {
+  public:
+    using shape_t = detail::grid_shape_t<Dims>;
+    using typename shape_t::index_t;
+
+    constexpr grid() = default;
+    constexpr grid(index_t min, index_t max, int padding = 0, T fill = {},
+                   T border = {})
+        : shape_t{min, max, padding}, cells(this->size(), fill) {
+        if (border != fill) {
+            this->for_each_padding([&](size_t i) { cells[i] = border; });
+        }
+    }
+
+    constexpr auto operator[](index_t pt) -> T & {
+        return cells[this->offset(pt)];
+    }
+    constexpr auto operator[](index_t pt) const -> T const & {
+        return cells[this->offset(pt)];
+    }
+    // by offset, for loops over neighbour_offsets()
+    constexpr auto cell(size_t offset) -> T & { return cells[offset]; }
+    constexpr auto cell(size_t offset) const -> T const & {
+        return cells[offset];
+    }
+
+    constexpr auto data() -> T * { return cells.data(); }
+    constexpr auto data() const -> T const * { return cells.data(); }
+    constexpr auto begin() { return cells.begin(); }
+    constexpr auto begin() const { return cells.begin(); }
+    constexpr auto end() { return cells.end(); }
+    constexpr auto end() const { return cells.end(); }
+
+  private:
+    std::vector<T> cells;
+};
+
+// One bit per cell, for occupancy: 64 cells to a word, so even a large box
+// stays in cache.
+template <size_t Dims> class grid<bool, Dims> : public detail::grid_shape_t<Dims> {
+  public:
+    using shape_t = detail::grid_shape_t<Dims>;
+    using typename shape_t::index_t;
+
+    class reference {
+      public:
+        constexpr reference(uint64_t &word, uint64_t bit)
+            : word{word}, bit{bit} {}
+
+        constexpr operator bool() const { return word & bit; }
+        constexpr auto operator=(bool value) -> reference & {
+            word = value ? word | bit : word & ~bit;
+            return *this;
+        }
+        constexpr auto operator=(reference const &other) -> reference & {
+            return *this = bool(other);
+        }
+
+      private:
+        uint64_t &word;
+        uint64_t bit;
+    };
+
+    constexpr grid() = default;
+    constexpr grid(index_t min, index_t max, int padding = 0, bool fill = false,
+                   bool border = false)
+        : shape_t{min, max, padding},
+          words((this->size() + 63) / 64, fill ? ~uint64_t{0} : 0) {
+        if (border != fill) {
+            this->for_each_padding([&](size_t i) { cell(i) = border; });
+        }
+    }
+
+    constexpr auto operator[](index_t pt) const -> bool {
+        return cell(this->offset(pt));
+    }
+    constexpr auto operator[](index_t pt) -> reference {
+        return cell(this->offset(pt));
+    }
+
+    // by offset, for loops over neighbour_offsets()
+    constexpr auto cell(size_t offset) const -> bool {
+        return words[offset / 64] >> (offset % 64) & 1;
+    }
+    constexpr auto cell(size_t offset) -> reference {
+        return {words[offset / 64], uint64_t{1} << (offset % 64)};
+    }
+
+    // sets it and tells whether it was already set, like a set's insert
+    constexpr auto set(size_t offset) -> bool {
+        auto &word = words[offset / 64];
+        auto const bit = uint64_t{1} << (offset % 64);
+        auto const was = (word & bit) != 0;
+        word |= bit;
+        return was;
+    }
+    constexpr auto set(index_t pt) -> bool { return set(this->offset(pt)); }
+
+    // cells set, padding included
+    constexpr auto count() const -> size_t {
+        auto result = size_t{0};
+        for (auto const word : words) {
+            result += std::popcount(word);
+        }
+        // the unused bits of the last word, if `fill` set them
+        if (auto const tail = this->size() % 64; tail && !words.empty()) {
+            result -= std::popcount(words.back() >> tail);
+        }
+        return result;
+    }
+
+  private:
+    std::vector<uint64_t> words;
+};
+
+// helpful with std::visit
+template <class... Ts> struct overloaded : Ts... {
+    using Ts::operator()...;
+};
+template <class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
 
-    println(diff.count(), "us");
-}
\ No newline at end of file
+#include "parallel.hh"
+#include "bench.hh"
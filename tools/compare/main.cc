@@ -0,0 +1,278 @@
+// Compares the benchmark results the solvers append with --results, between
+// two runs or two commits, day by day and phase by phase. Samples of both
+// sides go through a Mann-Whitney U test (no assumption about how the timings
+// are distributed, and a few outliers don't throw it off), a phase regressed
+// when its median got slower by more than the threshold and the test says
+// it's not noise. Exits with 1 when something regressed.
+//
+//   compare RESULTS [BASE NEW] [--threshold PCT] [--alpha P] [--phase NAME]
+//
+// BASE and NEW are a run id, a commit (any prefix) or `latest`/`previous`,
+// the last two runs of every day. Without them it's `previous latest`. Only
+// results on the same input (by hash) are compared.
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "fast_io.h"
+
+#include "../../lib/utils.hh"
+
+struct record_t {
+    std::string_view run;
+    std::string_view day;
+    std::string_view phase;
+    std::string_view input;
+    std::string_view commit;
+    std::vector<double> samples;
+};
+
+// The value of `key` in one of the flat objects bench::recorder_t writes,
+// quotes stripped. Not a JSON parser, it only has to read what we write.
+auto field(std::string_view line, std::string_view key) -> std::string_view {
+    auto const needle = "\""s + std::string{key} + "\":";
+    auto start = line.find(needle);
+    if (start == std::string_view::npos) {
+        return {};
+    }
+    start += needle.size();
+
+    if (line[start] == '"') {
+        auto const end = line.find('"', start + 1);
+        return line.substr(start + 1, end - start - 1);
+    }
+    if (line[start] == '[') {
+        auto const end = line.find(']', start);
+        return line.substr(start + 1, end - start - 1);
+    }
+    return line.substr(start, line.find_first_of(",}", start) - start);
+}
+
+auto parse(std::string_view input) -> std::vector<record_t> {
+    auto records = std::vector<record_t>{};
+
+    for (auto const line : line_index_t::lines(input)) {
+        if (line.empty()) {
+            continue;
+        }
+
+        auto record = record_t{
+            .run = field(line, "run"sv),
+            .day = field(line, "day"sv),
+            .phase = field(line, "phase"sv),
+            .input = field(line, "input"sv),
+            .commit = field(line, "commit"sv),
+            .samples = {},
+        };
+        auto const samples = field(line, "samples_us"sv);
+        for (auto const sample : samples | vw::split(","sv)) {
+            auto const text = std::string_view{sample.begin(), sample.end()};
+            auto value = 0.0;
+            if (std::from_chars(text.data(), text.data() + text.size(), value)
+                    .ec == std::errc{}) {
+                record.samples.push_back(value);
+            }
+        }
+        records.push_back(std::move(record));
+    }
+
+    return records;
+}
+
+// Two sided p-value of the Mann-Whitney U test, normal approximation with
+// tie correction, fine from about 8 samples a side.
+auto mann_whitney(std::vector<double> const &a, std::vector<double> const &b)
+    -> double {
+    auto const n1 = static_cast<double>(a.size());
+    auto const n2 = static_cast<double>(b.size());
+    auto const n = n1 + n2;
+
+    // (value, from a)
+    auto all = std::vector<std::pair<double, bool>>{};
+    for (auto const x : a) {
+        all.emplace_back(x, true);
+    }
+    for (auto const x : b) {
+        all.emplace_back(x, false);
+    }
+    rg::sort(all);
+
+    // average ranks for ties
+    auto rank_sum = 0.0;
+    auto ties = 0.0;
+    for (size_t i = 0; i < all.size();) {
+        auto j = i;
+        while (j < all.size() && all[j].first == all[i].first) {
+            ++j;
+        }
+        auto const rank = (i + 1 + j) / 2.0;
+        for (auto k = i; k < j; ++k) {
+            if (all[k].second) {
+                rank_sum += rank;
+            }
+        }
+        auto const t = static_cast<double>(j - i);
+        ties += t * t * t - t;
+        i = j;
+    }
+
+    auto const u = rank_sum - n1 * (n1 + 1) / 2;
+    auto const mean = n1 * n2 / 2;
+    auto const variance = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)));
+    if (variance <= 0) {
+        return 1.0;
+    }
+
+    // continuity correction
+    auto const z =
+        std::max(0.0, std::abs(u - mean) - 0.5) / std::sqrt(variance);
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+auto median(std::vector<double> samples) -> double {
+    rg::sort(samples);
+    auto const n = samples.size();
+    return n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+}
+
+[[noreturn]] auto usage(char const *argv0) -> void {
+    perrln("usage: "sv, std::string_view{argv0},
+           " RESULTS [BASE NEW] [--threshold PCT] [--alpha P]"sv,
+           " [--phase NAME]"sv);
+    perrln("BASE and NEW: a run id, a commit (prefix), latest or previous"sv);
+    std::exit(2);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+    }
+
+    auto selectors = std::vector<std::string_view>{};
+    auto threshold = 5.0; // percent
+    auto alpha = 0.01;
+    auto only_phase = std::string_view{};
+
+    for (int i = 2; i < argc; ++i) {
+        auto const arg = std::string_view{argv[i]};
+        if (!arg.starts_with("--"sv)) {
+            selectors.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+        }
+        auto const value = std::string_view{argv[++i]};
+
+        auto const end = value.data() + value.size();
+        if (arg == "--threshold"sv) {
+            std::from_chars(value.data(), end, threshold);
+        } else if (arg == "--alpha"sv) {
+            std::from_chars(value.data(), end, alpha);
+        } else if (arg == "--phase"sv) {
+            only_phase = value;
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    if (selectors.empty()) {
+        selectors = {"previous"sv, "latest"sv};
+    }
+    if (selectors.size() != 2) {
+        usage(argv[0]);
+    }
+
+    auto const file = fast_io::native_file_loader(argv[1]);
+    auto const records = parse(std::string_view{file});
+
+    // day, phase, input -> records in file order, so in time order
+    using key_t =
+        std::tuple<std::string_view, std::string_view, std::string_view>;
+    auto groups = std::map<key_t, std::vector<record_t const *>>{};
+    for (auto const &record : records) {
+        if (only_phase.empty() || record.phase == only_phase) {
+            groups[{record.day, record.phase, record.input}].push_back(&record);
+        }
+    }
+
+    // all the samples of the records `selector` picks out of one group
+    auto const select = [](std::vector<record_t const *> const &group,
+                           std::string_view selector) {
+        auto runs = std::vector<std::string_view>{};
+        for (auto const *record : group) {
+            if (runs.empty() || runs.back() != record->run) {
+                runs.push_back(record->run);
+            }
+        }
+
+        auto picked = std::optional<std::string_view>{};
+        if (selector == "latest"sv && !runs.empty()) {
+            picked = runs.back();
+        } else if (selector == "previous"sv && runs.size() >= 2) {
+            picked = runs[runs.size() - 2];
+        }
+
+        auto samples = std::vector<double>{};
+        for (auto const *record : group) {
+            auto const matches =
+                picked ? record->run == *picked
+                       : record->run == selector ||
+                             record->commit.starts_with(selector);
+            if (matches) {
+                samples.insert(samples.end(), record->samples.begin(),
+                               record->samples.end());
+            }
+        }
+        return samples;
+    };
+
+    auto compared = 0;
+    auto regressions = 0;
+
+    for (auto const &[key, group] : groups) {
+        auto const &[day, phase, input] = key;
+        auto const base = select(group, selectors[0]);
+        auto const next = select(group, selectors[1]);
+        if (base.empty() || next.empty()) {
+            continue;
+        }
+        ++compared;
+
+        auto const before = median(base);
+        auto const after = median(next);
+        auto const change = before > 0 ? (after / before - 1) * 100 : 0.0;
+        auto const p = mann_whitney(base, next);
+        auto const significant = p < alpha;
+
+        auto verdict = "same"sv;
+        if (significant && change > threshold) {
+            verdict = "REGRESSION"sv;
+            ++regressions;
+        } else if (significant && change < -threshold) {
+            verdict = "faster"sv;
+        } else if (significant) {
+            verdict = "within threshold"sv;
+        }
+
+        println(day, " "sv, phase, " ("sv, input.substr(0, 8), "): "sv,
+                bench::rounded(before), "us -> "sv, bench::rounded(after),
+                "us "sv, change >= 0 ? "+"sv : ""sv, bench::rounded(change),
+                "% p="sv, p, " ("sv, base.size(), " vs "sv, next.size(),
+                " samples) "sv, verdict);
+    }
+
+    if (compared == 0) {
+        perrln("nothing to compare: no day has results on both sides"sv);
+        return 2;
+    }
+    return regressions > 0 ? 1 : 0;
+}
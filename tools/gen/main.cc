@@ -0,0 +1,557 @@
+// Generates valid puzzle inputs of any size, so the solvers can be run on
+// more than the few KB of the real ones. Same day, size and seed always give
+// the exact same bytes: the rng is spelled out here instead of going through
+// <random>, whose distributions differ between standard libraries.
+//
+//   gen DAY SIZE [--seed N] [--depth N] [--out PATH]
+//
+// SIZE takes k/M/G suffixes (powers of 1000), what it counts depends on the
+// day, see `days` below.
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fast_io.h"
+
+#include "../../lib/utils.hh"
+
+// splitmix64
+struct rng_t {
+    uint64_t state;
+
+    constexpr auto next() -> uint64_t {
+        auto z = (state += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    // [0, n), multiply-shift, the bias is way below what matters here
+    constexpr auto below(uint64_t n) -> uint64_t {
+        return static_cast<uint64_t>(
+            (static_cast<unsigned __int128>(next()) * n) >> 64);
+    }
+
+    // [lo, hi]
+    constexpr auto between(int64_t lo, int64_t hi) -> int64_t {
+        return lo + static_cast<int64_t>(below(hi - lo + 1));
+    }
+
+    constexpr auto shuffle(rg::random_access_range auto &&range) -> void {
+        auto const n = rg::size(range);
+        for (size_t i = n; i > 1; --i) {
+            std::swap(range[i - 1], range[below(i)]);
+        }
+    }
+};
+
+// buffers everything, writes it out a MB at a time
+class writer_t {
+  public:
+    explicit writer_t(char const *path) {
+        if (path) {
+            file.emplace(path);
+        }
+        buffer.reserve(capacity + 64);
+    }
+
+    writer_t(writer_t const &) = delete;
+    auto operator=(writer_t const &) -> writer_t & = delete;
+
+    // none of the real inputs end with a newline, and some solvers count on it
+    ~writer_t() {
+        if (buffer.ends_with('\n')) {
+            buffer.pop_back();
+        }
+        flush(buffer.size());
+    }
+
+    auto put(std::string_view str) -> writer_t & {
+        buffer.append(str);
+        return maybe_flush();
+    }
+
+    auto put(char ch) -> writer_t & {
+        buffer.push_back(ch);
+        return maybe_flush();
+    }
+
+    auto put(std::integral auto value) -> writer_t & {
+        char digits[24];
+        auto const [end, ec] = std::to_chars(digits, digits + 24, value);
+        buffer.append(digits, end);
+        return maybe_flush();
+    }
+
+  private:
+    static constexpr size_t capacity = 1 << 20;
+
+    // the last byte stays behind, it might be the final newline
+    auto maybe_flush() -> writer_t & {
+        if (buffer.size() >= capacity) {
+            flush(buffer.size() - 1);
+        }
+        return *this;
+    }
+
+    auto flush(size_t bytes) -> void {
+        auto const chunk = std::string_view{buffer}.substr(0, bytes);
+        if (file) {
+            print(*file, chunk);
+        } else {
+            print(chunk);
+        }
+        buffer.erase(0, bytes);
+    }
+
+    std::optional<fast_io::obuf_file> file;
+    std::string buffer;
+};
+
+struct params_t {
+    uint64_t size;
+    int depth;
+};
+
+// elves, 1 to 15 snacks each
+auto day01(rng_t &rng, writer_t &out, params_t params) -> void {
+    for (uint64_t elf = 0; elf < params.size; ++elf) {
+        if (elf) {
+            out.put('\n');
+        }
+        for (auto snack = rng.between(1, 15); snack > 0; --snack) {
+            out.put(rng.between(1000, 60000)).put('\n');
+        }
+    }
+}
+
+// rounds, 4 bytes each
+auto day02(rng_t &rng, writer_t &out, params_t params) -> void {
+    for (uint64_t round = 0; round < params.size; ++round) {
+        char const line[4]{static_cast<char>('A' + rng.below(3)), ' ',
+                           static_cast<char>('X' + rng.below(3)), '\n'};
+        out.put(std::string_view{line, 4});
+    }
+}
+
+// groups of 3 rucksacks. The letters are dealt out in three hands of 17 plus
+// the badge, so the badge is the only item all three share. In each rucksack
+// one item goes in both halves, the rest of its hand is split between them.
+auto day03(rng_t &rng, writer_t &out, params_t params) -> void {
+    auto letters = std::array<char, 52>{};
+    for (int i = 0; i < 26; ++i) {
+        letters[i] = 'a' + i;
+        letters[26 + i] = 'A' + i;
+    }
+
+    for (uint64_t group = 0; group < params.size; ++group) {
+        rng.shuffle(letters);
+        auto const badge = letters[51];
+
+        for (int elf = 0; elf < 3; ++elf) {
+            auto hand = std::vector<char>(letters.begin() + 17 * elf,
+                                          letters.begin() + 17 * (elf + 1));
+            hand.push_back(badge);
+            rng.shuffle(hand);
+
+            auto const shared = hand.back();
+            hand.pop_back();
+
+            auto const split = rng.between(1, hand.size() - 1);
+            auto const left = std::span{hand}.first(split);
+            auto const right = std::span{hand}.subspan(split);
+            auto const badge_left = rg::find(left, badge) != left.end();
+            auto const badge_right = rg::find(right, badge) != right.end();
+
+            auto const half = rng.between(3, 16);
+            auto const fill = [&](std::span<char const> pool, bool with_badge) {
+                auto items = std::string{shared};
+                if (with_badge) {
+                    items.push_back(badge);
+                }
+                while (items.size() < static_cast<size_t>(half)) {
+                    items.push_back(pool[rng.below(pool.size())]);
+                }
+                rng.shuffle(items);
+                out.put(std::string_view{items});
+            };
+
+            fill(left, badge_left);
+            fill(right, badge_right);
+            out.put('\n');
+        }
+    }
+}
+
+// pairs of section ranges
+auto day04(rng_t &rng, writer_t &out, params_t params) -> void {
+    for (uint64_t pair = 0; pair < params.size; ++pair) {
+        auto const start_1 = rng.between(1, 99);
+        auto const end_1 = rng.between(start_1, 99);
+        auto const start_2 = rng.between(1, 99);
+        auto const end_2 = rng.between(start_2, 99);
+
+        out.put(start_1).put('-').put(end_1).put(',');
+        out.put(start_2).put('-').put(end_2).put('\n');
+    }
+}
+
+// characters (at least 200). 3 letters for the first 60% (so no marker of 4
+// yet), then 13 (no marker of 14 yet) until 90%, then 14 distinct ones, then
+// anything
+auto day06(rng_t &rng, writer_t &out, params_t params) -> void {
+    auto const size = std::max<uint64_t>(params.size, 200);
+    auto alphabet = std::array<char, 26>{};
+    rg::generate(alphabet, [ch = 'a']() mutable { return ch++; });
+
+    auto const run = [&](uint64_t length, size_t letters) {
+        rng.shuffle(alphabet);
+        for (uint64_t i = 0; i < length; ++i) {
+            out.put(alphabet[rng.below(letters)]);
+        }
+    };
+
+    auto const first = size * 6 / 10;
+    auto const second = size * 9 / 10;
+
+    run(first, 3);
+    run(second - first, 13);
+
+    rng.shuffle(alphabet);
+    out.put(std::string_view{alphabet.data(), 14});
+
+    run(size - second - 14, 26);
+    out.put('\n');
+}
+
+// files, spread over a random directory tree. Sizes are picked so the disk
+// ends up around 50M of the 70M used, like the real thing.
+auto day07(rng_t &rng, writer_t &out, params_t params) -> void {
+    auto const average =
+        std::max<uint64_t>(50'000'000 / std::max<uint64_t>(params.size, 1), 1);
+    auto counter = uint64_t{0};
+
+    // unique names, a random word plus a counter
+    auto const name = [&] {
+        auto result = std::string{};
+        for (auto length = rng.between(1, 6); length > 0; --length) {
+            result.push_back('a' + rng.below(26));
+        }
+        for (auto n = counter++; n; n /= 26) {
+            result.push_back('a' + n % 26);
+        }
+        return result;
+    };
+
+    auto const dir = [&](auto const &self, uint64_t files,
+                         int depth) -> void {
+        auto here = std::min<uint64_t>(files, rng.between(0, 8));
+        auto const subdirs =
+            files == here ? 0 : depth >= 64 ? 0 : rng.between(1, 4);
+        if (subdirs == 0) {
+            here = files;
+        }
+
+        out.put("$ ls\n"sv);
+
+        auto names = std::vector<std::string>{};
+        for (int i = 0; i < subdirs; ++i) {
+            names.push_back(name());
+            out.put("dir "sv).put(std::string_view{names.back()}).put('\n');
+        }
+        for (uint64_t i = 0; i < here; ++i) {
+            out.put(rng.between(1, 2 * average)).put(' ');
+            out.put(std::string_view{name()});
+            if (rng.below(2)) {
+                out.put(".txt"sv);
+            }
+            out.put('\n');
+        }
+
+        auto left = files - here;
+        for (int i = 0; i < subdirs; ++i) {
+            auto const share =
+                i + 1 == subdirs ? left : rng.below(left + 1);
+            left -= share;
+
+            out.put("$ cd "sv).put(std::string_view{names[i]}).put('\n');
+            self(self, share, depth + 1);
+            out.put("$ cd ..\n"sv);
+        }
+    };
+
+    out.put("$ cd /\n"sv);
+    dir(dir, params.size, 0);
+}
+
+// a square grid of trees, SIZE by SIZE, taller towards the middle
+auto day08(rng_t &rng, writer_t &out, params_t params) -> void {
+    auto const side = static_cast<int64_t>(std::max<uint64_t>(params.size, 2));
+
+    for (int64_t i = 0; i < side; ++i) {
+        for (int64_t j = 0; j < side; ++j) {
+            auto const edge = std::min({i, j, side - 1 - i, side - 1 - j});
+            auto const base = 9 * edge / std::max<int64_t>(side / 2, 1);
+            auto const height = std::clamp<int64_t>(base + rng.between(-3, 3), 0, 9);
+            out.put(static_cast<char>('0' + height));
+        }
+        out.put('\n');
+    }
+}
+
+// 8 monkeys like the real input (the solver multiplies every divisor into an
+// int, more would overflow it), SIZE items between them (at least 8)
+auto day11(rng_t &rng, writer_t &out, params_t params) -> void {
+    constexpr auto monkeys = 8;
+    auto divisors = std::array{2, 3, 5, 7, 11, 13, 17, 19};
+    rng.shuffle(divisors);
+    auto const squares = rng.below(monkeys);
+
+    // the solver wants at least one item each
+    auto items = std::array<std::vector<int64_t>, monkeys>{};
+    for (uint64_t i = 0; i < std::max<uint64_t>(params.size, monkeys); ++i) {
+        auto const to = i < monkeys ? i : rng.below(monkeys);
+        items[to].push_back(rng.between(50, 99));
+    }
+
+    for (int monkey = 0; monkey < monkeys; ++monkey) {
+        if (monkey) {
+            out.put('\n');
+        }
+        out.put("Monkey "sv).put(monkey).put(":\n  Starting items: "sv);
+        for (size_t i = 0; i < items[monkey].size(); ++i) {
+            if (i) {
+                out.put(", "sv);
+            }
+            out.put(items[monkey][i]);
+        }
+
+        out.put("\n  Operation: new = old "sv);
+        if (static_cast<int>(squares) == monkey) {
+            out.put("* old"sv);
+        } else {
+            out.put(rng.below(2) ? "* "sv : "+ "sv).put(rng.between(1, 19));
+        }
+
+        // two other monkeys
+        auto const when_true = (monkey + rng.between(1, monkeys - 1)) % monkeys;
+        auto when_false = when_true;
+        while (when_false == when_true || when_false == monkey) {
+            when_false = rng.below(monkeys);
+        }
+
+        out.put("\n  Test: divisible by "sv).put(divisors[monkey]);
+        out.put("\n    If true: throw to monkey "sv).put(when_true);
+        out.put("\n    If false: throw to monkey "sv).put(when_false);
+        out.put('\n');
+    }
+}
+
+// pairs of packets, nested up to --depth
+auto day13(rng_t &rng, writer_t &out, params_t params) -> void {
+    auto const packet = [&](auto const &self, std::string &into,
+                            int depth) -> void {
+        into.push_back('[');
+        for (auto length = rng.between(0, 5), i = int64_t{0}; i < length; ++i) {
+            if (i) {
+                into.push_back(',');
+            }
+            if (depth < params.depth && rng.below(3) == 0) {
+                self(self, into, depth + 1);
+            } else {
+                into.append(std::to_string(rng.between(0, 10)));
+            }
+        }
+        into.push_back(']');
+    };
+
+    auto left = std::string{};
+    auto right = std::string{};
+    for (uint64_t pair = 0; pair < params.size; ++pair) {
+        // equal packets have no order
+        do {
+            left.clear();
+            right.clear();
+            packet(packet, left, 0);
+            packet(packet, right, 0);
+        } while (left == right);
+
+        if (pair) {
+            out.put('\n');
+        }
+        out.put(std::string_view{left}).put('\n');
+        out.put(std::string_view{right}).put('\n');
+    }
+}
+
+// rock paths, the cave grows with the count so that rock stays sparse
+// (around 5% of it) and the sand of part 1 still finds its way out
+auto day14(rng_t &rng, writer_t &out, params_t params) -> void {
+    auto const depth = 20 + static_cast<int64_t>(
+                                8 * std::sqrt(static_cast<double>(params.size)));
+
+    for (uint64_t path = 0; path < params.size; ++path) {
+        auto x = rng.between(500 - depth, 500 + depth);
+        auto y = rng.between(1, depth);
+        out.put(x).put(',').put(y);
+
+        auto horizontal = rng.below(2) == 0;
+        for (auto points = rng.between(1, 5); points > 0; --points) {
+            auto const step = rng.between(1, 8) * (rng.below(2) ? 1 : -1);
+            auto &coord = horizontal ? x : y;
+            auto const moved =
+                horizontal ? std::clamp(x + step, 500 - depth, 500 + depth)
+                           : std::clamp(y + step, int64_t{1}, depth);
+            horizontal = !horizontal;
+            if (moved == coord) {
+                continue;
+            }
+            coord = moved;
+            out.put(" -> "sv).put(x).put(',').put(y);
+        }
+        out.put('\n');
+    }
+}
+
+// distinct cubes in a box about 40% full
+auto day18(rng_t &rng, writer_t &out, params_t params) -> void {
+    auto const side = std::max<uint64_t>(
+        3, std::ceil(std::cbrt(static_cast<double>(params.size) * 2.5)));
+    auto taken = std::vector<bool>(side * side * side);
+
+    for (uint64_t placed = 0; placed < params.size;) {
+        auto const cell = rng.below(taken.size());
+        if (taken[cell]) {
+            continue;
+        }
+        taken[cell] = true;
+        ++placed;
+
+        out.put(cell % side + 1).put(',');
+        out.put(cell / side % side + 1).put(',');
+        out.put(cell / side / side + 1).put('\n');
+    }
+}
+
+// numbers, exactly one of them 0
+auto day20(rng_t &rng, writer_t &out, params_t params) -> void {
+    auto const size = std::max<uint64_t>(params.size, 1);
+    auto const zero = rng.below(size);
+
+    for (uint64_t i = 0; i < size; ++i) {
+        auto value = i == zero ? 0 : rng.between(-10000, 9999);
+        if (i != zero && value >= 0) {
+            ++value;
+        }
+        out.put(value).put('\n');
+    }
+}
+
+using generator_t = auto (*)(rng_t &, writer_t &, params_t) -> void;
+
+struct day_t {
+    std::string_view name;
+    generator_t generate;
+    std::string_view size;
+};
+
+constexpr auto days = std::array{
+    day_t{"day01"sv, day01, "elves"sv},
+    day_t{"day02"sv, day02, "rounds (4 bytes each)"sv},
+    day_t{"day03"sv, day03, "groups of 3 rucksacks"sv},
+    day_t{"day04"sv, day04, "pairs"sv},
+    day_t{"day06"sv, day06, "characters"sv},
+    day_t{"day07"sv, day07, "files"sv},
+    day_t{"day08"sv, day08, "side of the grid"sv},
+    day_t{"day10"sv, day08, "side of the grid"sv},
+    day_t{"day11"sv, day11, "items"sv},
+    day_t{"day13"sv, day13, "pairs of packets"sv},
+    day_t{"day14"sv, day14, "rock paths"sv},
+    day_t{"day18"sv, day18, "cubes"sv},
+    day_t{"day20"sv, day20, "numbers"sv},
+};
+
+// 10k, 5M, 1G
+auto parse_size(std::string_view str) -> std::optional<uint64_t> {
+    auto value = uint64_t{};
+    auto const [end, ec] =
+        std::from_chars(str.data(), str.data() + str.size(), value);
+    if (ec != std::errc{} || end == str.data()) {
+        return {};
+    }
+
+    auto const suffix = std::string_view{end, str.data() + str.size()};
+    if (suffix.empty()) {
+        return value;
+    }
+    if (suffix == "k"sv) {
+        return value * 1'000;
+    }
+    if (suffix == "M"sv) {
+        return value * 1'000'000;
+    }
+    if (suffix == "G"sv) {
+        return value * 1'000'000'000;
+    }
+    return {};
+}
+
+[[noreturn]] auto usage(char const *argv0) -> void {
+    perrln("usage: "sv, std::string_view{argv0},
+           " DAY SIZE [--seed N] [--depth N] [--out PATH]"sv);
+    perrln("SIZE takes k/M/G suffixes and counts:"sv);
+    for (auto const &day : days) {
+        perrln("  "sv, day.name, ": "sv, day.size);
+    }
+    std::exit(2);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        usage(argv[0]);
+    }
+
+    auto const day = rg::find(days, std::string_view{argv[1]}, &day_t::name);
+    auto const size = parse_size(argv[2]);
+    if (day == days.end() || !size) {
+        usage(argv[0]);
+    }
+
+    auto seed = uint64_t{2022};
+    auto params = params_t{.size = *size, .depth = 6};
+    char const *path = nullptr;
+
+    for (int i = 3; i < argc; ++i) {
+        auto const arg = std::string_view{argv[i]};
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+        }
+        auto const value = std::string_view{argv[++i]};
+
+        if (arg == "--seed"sv) {
+            auto const parsed = parse_size(value);
+            if (!parsed) {
+                usage(argv[0]);
+            }
+            seed = *parsed;
+        } else if (arg == "--depth"sv) {
+            params.depth = std::max(0, to_int(value));
+        } else if (arg == "--out"sv) {
+            path = value.data();
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    auto rng = rng_t{seed};
+    auto out = writer_t{path};
+    day->generate(rng, out, params);
+}
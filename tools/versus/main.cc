@@ -0,0 +1,269 @@
+// Runs every day06 implementation (the C++ solver, day06_futhark when it's
+// built, both Python scripts and the Java one) on the same generated inputs,
+// from small to big, checks the others against the C++ solver's answers, and
+// prints their throughput as a table, input bytes per second of wall time.
+// That's the whole process, interpreter or JVM startup included, so the
+// small sizes mostly show what starting up costs.
+//
+//   versus [--sizes 10k,1M,...] [--runs N] [--budget SECS] [--dir PATH]
+//
+// Every size is `gen day06 SIZE`, written once under --dir. A time is the
+// best of --runs. Once an implementation takes longer than --budget seconds
+// it sits out the bigger sizes, except the C++ one, which the rest are
+// checked against. Exits with 1 when any answers disagree, or when the C++
+// solver fails and there's nothing to check them against.
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "fast_io.h"
+
+#include "../../lib/utils.hh"
+
+namespace fs = std::filesystem;
+
+// stamped in by CMakeLists.txt
+#if !defined(AOC22_SOURCE_DIR)
+#define AOC22_SOURCE_DIR "."
+#endif
+
+struct implementation_t {
+    std::string_view name;
+    std::vector<std::string> command;
+    // py/main.py prints part 2 first
+    bool swapped = false;
+};
+
+auto implementations() -> std::vector<implementation_t> {
+    auto const source = std::string{AOC22_SOURCE_DIR} + "/day06/";
+    auto all = std::vector<implementation_t>{
+        {"c++"sv, {AOC22_DAY06, "--warmup", "0", "--runs", "1"}},
+    };
+#if defined(AOC22_DAY06_FUTHARK)
+    all.push_back({"futhark"sv,
+                   {AOC22_DAY06_FUTHARK, "--warmup", "0", "--runs", "1"}});
+#endif
+    all.push_back({"python"sv, {"python3", source + "main.py"}});
+    all.push_back({"py/python"sv, {"python3", source + "py/main.py"}, true});
+    all.push_back({"java"sv, {"java", source + "java/main.java"}});
+    return all;
+}
+
+struct run_t {
+    double seconds;
+    std::string output;
+};
+
+// Runs `command` in `dir` (they all read ./input), stdout captured, stderr
+// thrown away. Empty when it can't be started or doesn't exit with 0.
+auto run(std::vector<std::string> const &command, fs::path const &dir)
+    -> std::optional<run_t> {
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) {
+        return {};
+    }
+
+    auto const then = std::chrono::steady_clock::now();
+    auto const pid = fork();
+    if (pid == 0) {
+        dup2(pipe_fds[1], STDOUT_FILENO);
+        auto const null = open("/dev/null", O_WRONLY);
+        dup2(null, STDERR_FILENO);
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+
+        auto argv = std::vector<char *>{};
+        for (auto const &arg : command) {
+            argv.push_back(const_cast<char *>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+        if (chdir(dir.c_str()) == 0) {
+            execvp(argv[0], argv.data());
+        }
+        _exit(127);
+    }
+    close(pipe_fds[1]);
+    if (pid < 0) {
+        close(pipe_fds[0]);
+        return {};
+    }
+
+    auto output = std::string{};
+    char buffer[4096];
+    for (auto n = read(pipe_fds[0], buffer, sizeof buffer); n > 0;
+         n = read(pipe_fds[0], buffer, sizeof buffer)) {
+        output.append(buffer, n);
+    }
+    close(pipe_fds[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    auto const seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - then)
+                             .count();
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return {};
+    }
+    return run_t{seconds, std::move(output)};
+}
+
+// the first two lines that are numbers, part 1 then part 2
+auto answers(std::string_view output, bool swapped)
+    -> std::optional<std::pair<int64_t, int64_t>> {
+    auto found = std::vector<int64_t>{};
+    for (auto const line : line_index_t::lines(output)) {
+        auto value = int64_t{};
+        auto const end = line.data() + line.size();
+        auto const [ptr, ec] = std::from_chars(line.data(), end, value);
+        if (ec == std::errc{} && ptr == end && !line.empty()) {
+            found.push_back(value);
+        }
+        if (found.size() == 2) {
+            return swapped ? std::pair{found[1], found[0]}
+                           : std::pair{found[0], found[1]};
+        }
+    }
+    return {};
+}
+
+// left aligned in `width` columns
+auto cell(std::string_view text, size_t width = 14) -> void {
+    print(text);
+    for (auto i = text.size(); i < width; ++i) {
+        print(" "sv);
+    }
+}
+
+[[noreturn]] auto usage(char const *argv0) -> void {
+    perrln("usage: "sv, std::string_view{argv0},
+           " [--sizes 10k,1M,...] [--runs N] [--budget SECS] [--dir PATH]"sv);
+    std::exit(2);
+}
+
+int main(int argc, char **argv) {
+    auto sizes = "10k,100k,1M,10M,100M"sv;
+    auto runs = 3;
+    auto budget = 10.0;
+    auto dir = fs::temp_directory_path() / "aoc22-versus";
+
+    for (int i = 1; i < argc; ++i) {
+        auto const arg = std::string_view{argv[i]};
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+        }
+        auto const value = std::string_view{argv[++i]};
+
+        if (arg == "--sizes"sv) {
+            sizes = value;
+        } else if (arg == "--runs"sv) {
+            runs = std::max(1, to_int(value));
+        } else if (arg == "--budget"sv) {
+            std::from_chars(value.data(), value.data() + value.size(), budget);
+        } else if (arg == "--dir"sv) {
+            dir = fs::path{value};
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    auto all = implementations();
+    // an implementation over budget (or that failed) skips the rest
+    auto retired = std::vector<bool>(all.size());
+    auto disagreements = 0;
+    auto unchecked = false;
+
+    cell("bytes"sv);
+    for (auto const &implementation : all) {
+        cell(implementation.name);
+    }
+    println(""sv);
+
+    for (auto const size_range : sizes | vw::split(","sv)) {
+        auto const size = std::string{size_range.begin(), size_range.end()};
+        auto const size_dir = dir / size;
+        fs::create_directories(size_dir);
+        auto const input = size_dir / "input";
+
+        if (!fs::exists(input) &&
+            !run({AOC22_GEN, "day06", size, "--out", input.string()},
+                 size_dir)) {
+            perrln("versus: gen day06 "sv, std::string_view{size},
+                   " failed"sv);
+            return 2;
+        }
+        auto const bytes = static_cast<double>(fs::file_size(input));
+        cell(std::to_string(static_cast<uint64_t>(bytes)));
+
+        // all[0] is the C++ solver, the rest have to give its answers
+        auto expected = std::optional<std::pair<int64_t, int64_t>>{};
+        for (size_t i = 0; i < all.size(); ++i) {
+            if (retired[i]) {
+                cell("-"sv);
+                continue;
+            }
+
+            auto best = std::optional<double>{};
+            auto answer = std::optional<std::pair<int64_t, int64_t>>{};
+            for (int r = 0; r < runs; ++r) {
+                auto const result = run(all[i].command, size_dir);
+                if (!result) {
+                    break;
+                }
+                best = std::min(best.value_or(result->seconds),
+                                result->seconds);
+                answer = answers(result->output, all[i].swapped);
+                if (*best > budget) {
+                    break; // not worth repeating
+                }
+            }
+
+            if (!best || !answer) {
+                cell("failed"sv);
+                retired[i] = true;
+                continue;
+            }
+            if (*best > budget && i > 0) {
+                retired[i] = true;
+            }
+
+            if (i == 0) {
+                expected = answer;
+            } else if (!expected) {
+                if (!unchecked) {
+                    perrln("versus: no c++ answers from "sv,
+                           std::string_view{size},
+                           " on, the others are unchecked"sv);
+                }
+                unchecked = true;
+            } else if (*answer != *expected) {
+                ++disagreements;
+                auto const [part_1, part_2] = *answer;
+                perrln("versus: "sv, all[i].name, " answers "sv, part_1,
+                       " "sv, part_2, " on "sv,
+                       std::string_view{size}, ", expected "sv,
+                       expected->first, " "sv, expected->second);
+            }
+
+            char throughput[32];
+            std::snprintf(throughput, sizeof throughput, "%.2f MB/s",
+                          bytes / *best / 1e6);
+            cell(throughput);
+        }
+        println(""sv);
+    }
+
+    return disagreements > 0 || unchecked ? 1 : 0;
+}